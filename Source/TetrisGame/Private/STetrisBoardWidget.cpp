@@ -0,0 +1,276 @@
+#include "STetrisBoardWidget.h"
+#include "TetrisBoard.h"
+#include "TetrisPiece.h"
+#include "Rendering/DrawElements.h"
+#include "Styling/CoreStyle.h"
+
+namespace TetrisBoardWidget
+{
+    // Rows reserved per preview slot (4 for the piece + 1 gap)
+    constexpr int32 PreviewSlotRows = 5;
+}
+
+STetrisBoardWidget::STetrisBoardWidget()
+    : DesiredCellSize(16.f)
+    , PreviewColumns(4)
+{
+    SetCanTick(false);
+}
+
+STetrisBoardWidget::~STetrisBoardWidget()
+{
+    UnbindBoard();
+}
+
+void STetrisBoardWidget::Construct(const FArguments& InArgs)
+{
+    Palette = InArgs._Palette;
+    DesiredCellSize = InArgs._DesiredCellSize;
+    PreviewColumns = FMath::Max(0, InArgs._PreviewColumns);
+    SetBoard(InArgs._Board);
+}
+
+void STetrisBoardWidget::SetBoard(ATetrisBoard* InBoard)
+{
+    if (Board.Get() == InBoard && RevisionHandle.IsValid())
+    {
+        return;
+    }
+
+    UnbindBoard();
+    Board = InBoard;
+    if (InBoard)
+    {
+        RevisionHandle = InBoard->OnBoardRevisionChanged.AddSP(this, &STetrisBoardWidget::HandleBoardRevisionChanged);
+    }
+
+    CachedRevision = MAX_uint32;
+    Invalidate(EInvalidateWidgetReason::Layout);
+}
+
+void STetrisBoardWidget::SetPalette(const FPalette& InPalette)
+{
+    Palette = InPalette;
+    Invalidate(EInvalidateWidgetReason::Paint);
+}
+
+void STetrisBoardWidget::SetDesiredCellSize(float InCellSize)
+{
+    DesiredCellSize = InCellSize;
+    Invalidate(EInvalidateWidgetReason::Layout);
+}
+
+void STetrisBoardWidget::SetPreviewColumns(int32 InPreviewColumns)
+{
+    PreviewColumns = FMath::Max(0, InPreviewColumns);
+    CachedRevision = MAX_uint32;
+    Invalidate(EInvalidateWidgetReason::Layout);
+}
+
+void STetrisBoardWidget::UnbindBoard()
+{
+    if (ATetrisBoard* OldBoard = Board.Get())
+    {
+        OldBoard->OnBoardRevisionChanged.Remove(RevisionHandle);
+    }
+    RevisionHandle.Reset();
+}
+
+void STetrisBoardWidget::HandleBoardRevisionChanged(uint32 Revision)
+{
+    if (Revision != CachedRevision)
+    {
+        Invalidate(EInvalidateWidgetReason::Paint);
+    }
+}
+
+void STetrisBoardWidget::BuildRuns(TArray<FIntPoint>& Cells, int32 ClipWidth, int32 ClipHeight, TArray<FCellRun>& OutRuns)
+{
+    Cells.Sort([](const FIntPoint& A, const FIntPoint& B)
+    {
+        return A.Y != B.Y ? A.Y < B.Y : A.X < B.X;
+    });
+
+    for (const FIntPoint& Cell : Cells)
+    {
+        if (Cell.X < 0 || Cell.X >= ClipWidth || Cell.Y < 0 || Cell.Y >= ClipHeight)
+        {
+            continue;
+        }
+
+        if (OutRuns.Num() > 0)
+        {
+            FCellRun& Last = OutRuns.Last();
+            if (Last.Y == Cell.Y && Last.X + Last.Length == Cell.X)
+            {
+                ++Last.Length;
+                continue;
+            }
+        }
+        OutRuns.Add({ Cell.X, Cell.Y, 1 });
+    }
+}
+
+void STetrisBoardWidget::UpdateCache() const
+{
+    const ATetrisBoard* BoardPtr = Board.Get();
+    if (!BoardPtr)
+    {
+        CachedWidth = CachedHeight = 0;
+        LockedRuns.Reset();
+        ActiveRuns.Reset();
+        GhostRuns.Reset();
+        PreviewRuns.Reset();
+        CachedRevision = MAX_uint32;
+        return;
+    }
+
+    const uint32 Revision = static_cast<uint32>(BoardPtr->GetBoardRevision());
+    if (Revision == CachedRevision)
+    {
+        return;
+    }
+
+    CachedRevision = Revision;
+    CachedWidth = BoardPtr->Width;
+    CachedHeight = BoardPtr->Height;
+
+    LockedRuns.Reset();
+    ActiveRuns.Reset();
+    GhostRuns.Reset();
+    PreviewRuns.Reset();
+
+    // Locked cells, scanned row by row so runs come out already merged
+    for (int32 Y = 0; Y < CachedHeight; ++Y)
+    {
+        int32 RunStart = INDEX_NONE;
+        for (int32 X = 0; X <= CachedWidth; ++X)
+        {
+            const bool bFilled = X < CachedWidth && BoardPtr->IsCellOccupied(X, Y);
+            if (bFilled && RunStart == INDEX_NONE)
+            {
+                RunStart = X;
+            }
+            else if (!bFilled && RunStart != INDEX_NONE)
+            {
+                LockedRuns.Add({ RunStart, Y, X - RunStart });
+                RunStart = INDEX_NONE;
+            }
+        }
+    }
+
+    if (BoardPtr->GetGhostCells(ScratchCells))
+    {
+        BuildRuns(ScratchCells, CachedWidth, CachedHeight, GhostRuns);
+    }
+
+    if (BoardPtr->GetPieceCells(BoardPtr->CurrentPiece, ScratchCells))
+    {
+        BuildRuns(ScratchCells, CachedWidth, CachedHeight, ActiveRuns);
+    }
+
+    if (PreviewColumns > 0)
+    {
+        TArray<TSubclassOf<ATetrisPiece>> Queue;
+        BoardPtr->GetPreviewQueue(Queue);
+
+        const int32 PreviewX = CachedWidth + 1;
+        for (int32 Slot = 0; Slot < Queue.Num(); ++Slot)
+        {
+            const ATetrisPiece* PieceDefaults = Queue[Slot] ? Queue[Slot]->GetDefaultObject<ATetrisPiece>() : nullptr;
+            if (!PieceDefaults)
+            {
+                continue;
+            }
+            PieceDefaults->GetPreviewCells(ScratchCells);
+            if (ScratchCells.Num() == 0)
+            {
+                continue;
+            }
+
+            FIntPoint Min(MAX_int32, MAX_int32);
+            for (const FIntPoint& Cell : ScratchCells)
+            {
+                Min = Min.ComponentMin(Cell);
+            }
+
+            // Slots stack down from the top of the board
+            const int32 SlotBottom = CachedHeight - (Slot + 1) * TetrisBoardWidget::PreviewSlotRows + 1;
+            for (FIntPoint& Cell : ScratchCells)
+            {
+                Cell = FIntPoint(PreviewX + Cell.X - Min.X, SlotBottom + Cell.Y - Min.Y);
+            }
+            BuildRuns(ScratchCells, PreviewX + PreviewColumns, CachedHeight, PreviewRuns);
+        }
+    }
+}
+
+int32 STetrisBoardWidget::OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect,
+    FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const
+{
+    UpdateCache();
+    if (CachedWidth <= 0 || CachedHeight <= 0)
+    {
+        return LayerId;
+    }
+
+    const FSlateBrush* Brush = FCoreStyle::Get().GetBrush("WhiteBrush");
+    const ESlateDrawEffect DrawEffect = ShouldBeEnabled(bParentEnabled) ? ESlateDrawEffect::None : ESlateDrawEffect::DisabledEffect;
+    const FLinearColor Tint = InWidgetStyle.GetColorAndOpacityTint();
+
+    // Fit the board (plus preview column) into the allotted space, keeping cells square
+    const FVector2D LocalSize = AllottedGeometry.GetLocalSize();
+    const int32 TotalColumns = CachedWidth + (PreviewColumns > 0 ? PreviewColumns + 1 : 0);
+    const float CellPx = FMath::Min(LocalSize.X / TotalColumns, LocalSize.Y / CachedHeight);
+    if (CellPx <= 0.f)
+    {
+        return LayerId;
+    }
+
+    FSlateDrawElement::MakeBox(
+        OutDrawElements,
+        LayerId,
+        AllottedGeometry.ToPaintGeometry(FVector2D(CachedWidth * CellPx, CachedHeight * CellPx), FSlateLayoutTransform()),
+        Brush,
+        DrawEffect,
+        Palette.Background * Tint);
+
+    // Every cell box goes on the same layer with the same brush so Slate batches them together
+    const int32 CellLayer = LayerId + 1;
+    const float Inset = FMath::Max(1.f, CellPx * 0.06f);
+    auto DrawRuns = [&](const TArray<FCellRun>& Runs, const FLinearColor& Color)
+    {
+        const FLinearColor FinalColor = Color * Tint;
+        for (const FCellRun& Run : Runs)
+        {
+            const FVector2D Offset(Run.X * CellPx + Inset, (CachedHeight - 1 - Run.Y) * CellPx + Inset);
+            const FVector2D Size(Run.Length * CellPx - 2.f * Inset, CellPx - 2.f * Inset);
+            FSlateDrawElement::MakeBox(
+                OutDrawElements,
+                CellLayer,
+                AllottedGeometry.ToPaintGeometry(Size, FSlateLayoutTransform(Offset)),
+                Brush,
+                DrawEffect,
+                FinalColor);
+        }
+    };
+
+    DrawRuns(LockedRuns, Palette.Locked);
+    DrawRuns(GhostRuns, Palette.Ghost);
+    DrawRuns(ActiveRuns, Palette.Active);
+    DrawRuns(PreviewRuns, Palette.Preview);
+
+    return CellLayer;
+}
+
+FVector2D STetrisBoardWidget::ComputeDesiredSize(float LayoutScaleMultiplier) const
+{
+    const ATetrisBoard* BoardPtr = Board.Get();
+    if (!BoardPtr)
+    {
+        return FVector2D::ZeroVector;
+    }
+
+    const int32 TotalColumns = BoardPtr->Width + (PreviewColumns > 0 ? PreviewColumns + 1 : 0);
+    return FVector2D(TotalColumns * DesiredCellSize, BoardPtr->Height * DesiredCellSize);
+}
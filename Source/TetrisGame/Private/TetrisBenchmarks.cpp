@@ -0,0 +1,567 @@
+#include "CoreMinimal.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/RandomStream.h"
+#include "TetrisBoard.h"
+#include "TetrisBoardEval.h"
+#include "TetrisBoardGrid.h"
+#include "TetrisBoardKernels.h"
+#include "TetrisSimulation.h"
+#include "TetrisSnapshotRing.h"
+#include "TetrisSpectatorServer.h"
+#include "TetrisSpectatorStream.h"
+#include "IPAddress.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+
+/*
+ * Micro-benchmarks run from the console, e.g. "Tetris.BenchKernels 200000".
+ * Results are logged as nanoseconds per call for each path on identical inputs.
+ */
+namespace TetrisBenchmarks
+{
+    // Fill the lower part of a board with random rows, some of them complete
+    static void FillBoard(FTetrisBoardGrid& Grid, FRandomStream& Random)
+    {
+        for (int32 Y = 0; Y < Grid.GetHeight() * 3 / 4; ++Y)
+        {
+            const bool bFull = Random.FRand() < 0.25f;
+            for (int32 X = 0; X < Grid.GetWidth(); ++X)
+            {
+                Grid.SetOccupied(X, Y, bFull || Random.FRand() < 0.6f);
+            }
+        }
+    }
+
+    // Random four-cell placements spread over the board and a little above it
+    static void MakePlacements(const FTetrisBoardGrid& Grid, FRandomStream& Random, int32 Count, TArray<FIntPoint>& OutCells)
+    {
+        OutCells.Reset(Count * 4);
+        for (int32 Index = 0; Index < Count; ++Index)
+        {
+            const FIntPoint Origin(Random.RandRange(-1, Grid.GetWidth() - 3), Random.RandRange(0, Grid.GetHeight() + 2));
+            OutCells.Add(Origin);
+            OutCells.Add(Origin + FIntPoint(1, 0));
+            OutCells.Add(Origin + FIntPoint(2, 0));
+            OutCells.Add(Origin + FIntPoint(1, 1));
+        }
+    }
+
+    static double TimeCollision(const FTetrisBoardKernelOps& Ops, const FTetrisBoardGrid& Grid, const TArray<FIntPoint>& Cells, int32 Iterations, int64& Sink)
+    {
+        const int32 NumPlacements = Cells.Num() / 4;
+        const double Start = FPlatformTime::Seconds();
+        for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+        {
+            Sink += Ops.FindCollision(Grid, Cells.GetData() + (Iteration % NumPlacements) * 4, 4);
+        }
+        return (FPlatformTime::Seconds() - Start) * 1e9 / Iterations;
+    }
+
+    static double TimeClear(const FTetrisBoardKernelOps& Ops, FTetrisBoardGrid& Grid, const TArray<uint64>& Saved, int32 Iterations, int64& Sink)
+    {
+        // Restoring the rows is a single memcpy, so it adds the same small constant to both paths
+        const double Start = FPlatformTime::Seconds();
+        for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+        {
+            FMemory::Memcpy(Grid.GetMutableContiguousRows(), Saved.GetData(), Saved.Num() * sizeof(uint64));
+            Sink += Ops.ClearFullRows(Grid, 0, Grid.GetHeight() - 1);
+        }
+        return (FPlatformTime::Seconds() - Start) * 1e9 / Iterations;
+    }
+
+    // One line clear through the chunked grid: remove a random filled row, then push a garbage
+    // row back in so the stack keeps its height. Each iteration pays for both.
+    static double TimeGridClear(int32 Width, int32 Height, int32 Iterations, int64& Sink)
+    {
+        FRandomStream Random(1234);
+        FTetrisBoardGrid Grid;
+        Grid.Init(Width, Height);
+        FillBoard(Grid, Random);
+
+        TArray<uint64> Row;
+        Row.SetNumUninitialized(Grid.GetWordsPerRow());
+        for (int32 Word = 0; Word < Row.Num(); ++Word)
+        {
+            Row[Word] = Grid.GetWordMask(Word);
+        }
+        Row[0] &= ~uint64(1);
+
+        TArray<int32> Targets;
+        Targets.SetNumUninitialized(1024);
+        for (int32& Target : Targets)
+        {
+            Target = Random.RandRange(0, Height * 3 / 4 - 1);
+        }
+
+        const double Start = FPlatformTime::Seconds();
+        for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+        {
+            Grid.RemoveRow(Targets[Iteration % Targets.Num()]);
+            Sink += Grid.InsertRowAtBottom(Row.GetData());
+        }
+        return (FPlatformTime::Seconds() - Start) * 1e9 / Iterations;
+    }
+
+    static void RunKernelBenchmark(const TArray<FString>& Args)
+    {
+        const int32 Iterations = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 200000;
+        const FIntPoint Sizes[] = { FIntPoint(10, 20), FIntPoint(10, 40), FIntPoint(4, 20), FIntPoint(6, 20) };
+
+        int64 Sink = 0;
+        for (const FIntPoint& Size : Sizes)
+        {
+            FRandomStream Random(1234);
+            FTetrisBoardGrid Grid;
+            Grid.Init(Size.X, Size.Y);
+            FillBoard(Grid, Random);
+
+            TArray<uint64> Saved;
+            Saved.Append(Grid.GetContiguousRows(), Grid.GetHeight() * Grid.GetWordsPerRow());
+
+            TArray<FIntPoint> Cells;
+            MakePlacements(Grid, Random, 1024, Cells);
+
+            const FTetrisBoardKernelOps& Specialized = TetrisBoardKernels::Select(Size.X, Size.Y);
+            const FTetrisBoardKernelOps& Generic = TetrisBoardKernels::Generic();
+
+            const double GenericCollision = TimeCollision(Generic, Grid, Cells, Iterations, Sink);
+            const double SpecializedCollision = TimeCollision(Specialized, Grid, Cells, Iterations, Sink);
+            const double GenericClear = TimeClear(Generic, Grid, Saved, Iterations, Sink);
+            const double SpecializedClear = TimeClear(Specialized, Grid, Saved, Iterations, Sink);
+
+            UE_LOG(LogTemp, Display, TEXT("Tetris.BenchKernels %dx%d (%s): collision %.1f -> %.1f ns (%.2fx), clear %.1f -> %.1f ns (%.2fx)"),
+                Size.X, Size.Y, Specialized.Name,
+                GenericCollision, SpecializedCollision, GenericCollision / FMath::Max(SpecializedCollision, 0.001),
+                GenericClear, SpecializedClear, GenericClear / FMath::Max(SpecializedClear, 0.001));
+        }
+
+        // The cost the grid's chunking is meant to bound: a clear on a huge board against the default one
+        const double SmallGridClear = TimeGridClear(10, 20, Iterations, Sink);
+        const double LargeGridClear = TimeGridClear(64, 4096, Iterations, Sink);
+        UE_LOG(LogTemp, Display, TEXT("Tetris.BenchKernels grid clear: 10x20 %.1f ns, 64x4096 %.1f ns (%.2fx)"),
+            SmallGridClear, LargeGridClear, LargeGridClear / FMath::Max(SmallGridClear, 0.001));
+
+        UE_LOG(LogTemp, Verbose, TEXT("Tetris.BenchKernels sink %lld"), Sink);
+    }
+
+    static FAutoConsoleCommand BenchKernelsCommand(
+        TEXT("Tetris.BenchKernels"),
+        TEXT("Compare specialized board kernels with the generic runtime-size kernel. Optional arg: iterations."),
+        FConsoleCommandWithArgsDelegate::CreateStatic(&RunKernelBenchmark));
+
+    // Straightforward per-cell evaluation, the reference the bitboard paths must match
+    static FTetrisBoardFeatures EvaluateNaive(const uint64* Rows, int32 Width, int32 Height)
+    {
+        auto Filled = [&](int32 X, int32 Y)
+        {
+            return X < 0 || X >= Width || Y < 0 || ((Rows[Y] >> X) & 1) != 0;
+        };
+
+        FTetrisBoardFeatures Out;
+        TArray<int32> Heights;
+        Heights.SetNumZeroed(Width);
+        for (int32 X = 0; X < Width; ++X)
+        {
+            for (int32 Y = Height - 1; Y >= 0 && Heights[X] == 0; --Y)
+            {
+                if (Filled(X, Y))
+                {
+                    Heights[X] = Y + 1;
+                }
+            }
+            Out.AggregateHeight += Heights[X];
+            Out.MaxHeight = FMath::Max(Out.MaxHeight, Heights[X]);
+            if (X > 0)
+            {
+                Out.Bumpiness += FMath::Abs(Heights[X] - Heights[X - 1]);
+            }
+
+            for (int32 Y = 0; Y < Height; ++Y)
+            {
+                Out.Holes += Y < Heights[X] && !Filled(X, Y);
+                Out.WellDepthSum += Y >= Heights[X] && Filled(X - 1, Y) && Filled(X + 1, Y);
+                Out.ColumnTransitions += Filled(X, Y) != Filled(X, Y - 1);
+            }
+            Out.ColumnTransitions += Filled(X, Height - 1);
+        }
+
+        for (int32 Y = 0; Y < Out.MaxHeight; ++Y)
+        {
+            bool bFull = true;
+            for (int32 X = 0; X <= Width; ++X)
+            {
+                Out.RowTransitions += Filled(X, Y) != Filled(X - 1, Y);
+                bFull &= X == Width || Filled(X, Y);
+            }
+            Out.CompleteLines += bFull;
+        }
+        return Out;
+    }
+
+    // Boards a placement search would produce: ragged stacks with the odd hole and full row
+    static void MakeEvalBoards(FRandomStream& Random, int32 NumBoards, int32 Width, int32 Height, TArray<uint64>& OutRows)
+    {
+        OutRows.SetNumZeroed(NumBoards * Height);
+        for (int32 Board = 0; Board < NumBoards; ++Board)
+        {
+            uint64* Rows = OutRows.GetData() + Board * Height;
+            for (int32 X = 0; X < Width; ++X)
+            {
+                const int32 ColumnHeight = Random.RandRange(0, Height * 2 / 3);
+                for (int32 Y = 0; Y < ColumnHeight; ++Y)
+                {
+                    Rows[Y] |= uint64(Random.FRand() < 0.9f) << X;
+                }
+            }
+            if (Random.FRand() < 0.3f)
+            {
+                Rows[0] = Width == 64 ? ~uint64(0) : (uint64(1) << Width) - 1;
+            }
+        }
+    }
+
+    static double TimeEval(const TArray<uint64>& Rows, int32 NumBoards, int32 Width, int32 Height, int32 Iterations,
+        TFunctionRef<void(FTetrisBoardFeatures*)> Evaluate, TArray<FTetrisBoardFeatures>& OutFeatures)
+    {
+        OutFeatures.SetNumZeroed(NumBoards);
+        const double Start = FPlatformTime::Seconds();
+        for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+        {
+            Evaluate(OutFeatures.GetData());
+        }
+        return (FPlatformTime::Seconds() - Start) * 1e9 / (double(Iterations) * NumBoards);
+    }
+
+    static void RunEvalBenchmark(const TArray<FString>& Args)
+    {
+        const int32 Iterations = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 2000;
+        // Roughly one piece's worth of placements (all rotations and columns)
+        const int32 NumBoards = 34;
+        const FIntPoint Sizes[] = { FIntPoint(10, 20), FIntPoint(10, 40) };
+
+        for (const FIntPoint& Size : Sizes)
+        {
+            const int32 Width = Size.X;
+            const int32 Height = Size.Y;
+
+            FRandomStream Random(1234);
+            TArray<uint64> Rows;
+            MakeEvalBoards(Random, NumBoards, Width, Height, Rows);
+
+            TArray<FTetrisBoardFeatures> Reference;
+            const double NaiveNs = TimeEval(Rows, NumBoards, Width, Height, Iterations, [&](FTetrisBoardFeatures* Out)
+            {
+                for (int32 Board = 0; Board < NumBoards; ++Board)
+                {
+                    Out[Board] = EvaluateNaive(Rows.GetData() + Board * Height, Width, Height);
+                }
+            }, Reference);
+
+            FString Line = FString::Printf(TEXT("Tetris.BenchEval %dx%d, %d boards: naive %.1f ns/board"), Width, Height, NumBoards, NaiveNs);
+
+            const ETetrisSimdLevel Levels[] = { ETetrisSimdLevel::Scalar, ETetrisSimdLevel::SSE4, ETetrisSimdLevel::AVX2 };
+            for (ETetrisSimdLevel Level : Levels)
+            {
+                if (Level > TetrisBoardEval::GetSupportedSimdLevel())
+                {
+                    Line += FString::Printf(TEXT(", %s unsupported"), TetrisBoardEval::LexToString(Level));
+                    continue;
+                }
+
+                TArray<FTetrisBoardFeatures> Features;
+                const double LevelNs = TimeEval(Rows, NumBoards, Width, Height, Iterations, [&](FTetrisBoardFeatures* Out)
+                {
+                    TetrisBoardEval::EvaluateBoards(Rows.GetData(), NumBoards, Width, Height, Out, Level);
+                }, Features);
+
+                const bool bMatches = Features == Reference;
+                Line += FString::Printf(TEXT(", %s %.1f ns (%.2fx)%s"), TetrisBoardEval::LexToString(Level),
+                    LevelNs, NaiveNs / FMath::Max(LevelNs, 0.001), bMatches ? TEXT("") : TEXT(" MISMATCH"));
+            }
+
+            UE_LOG(LogTemp, Display, TEXT("%s"), *Line);
+        }
+    }
+
+    static FAutoConsoleCommand BenchEvalCommand(
+        TEXT("Tetris.BenchEval"),
+        TEXT("Compare board evaluation per SIMD level with a naive per-cell evaluator. Optional arg: iterations."),
+        FConsoleCommandWithArgsDelegate::CreateStatic(&RunEvalBenchmark));
+
+    // Average time of the board's full instance rebuild, which every Undo/Redo/RewindToPiece ends with,
+    // on a Width x Height board filled with garbage rows. Returns the instance count, or -1 without a board.
+    static int32 TimeVisualRebuild(UWorld* World, int32 Width, int32 Height, int32 Iterations, double& OutMicroseconds)
+    {
+        UStaticMesh* Cube = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+        FActorSpawnParameters SpawnParams;
+        SpawnParams.ObjectFlags |= RF_Transient;
+        ATetrisBoard* Board = Cube ? World->SpawnActor<ATetrisBoard>(SpawnParams) : nullptr;
+        if (!Board)
+        {
+            return -1;
+        }
+
+        Board->Width = Width;
+        Board->Height = Height;
+        Board->bDrawDebugGrid = false;
+        Board->UndoHistoryLimit = 0;
+        UInstancedStaticMeshComponent* Instances = Board->FindComponentByClass<UInstancedStaticMeshComponent>();
+        Instances->SetStaticMesh(Cube);
+        Board->Initialize();
+
+        // One hole per row, so every row but the top one stays full of blocks
+        Board->AddGarbageRows(Height - 1, 0);
+
+        const double Start = FPlatformTime::Seconds();
+        for (int32 Index = 0; Index < Iterations; ++Index)
+        {
+            Board->RebuildLockedBlockVisuals();
+        }
+        OutMicroseconds = (FPlatformTime::Seconds() - Start) * 1e6 / Iterations;
+
+        const int32 NumInstances = Instances->GetInstanceCount();
+        Board->Destroy();
+        return NumInstances;
+    }
+
+    static void RunUndoBenchmark(const TArray<FString>& Args, UWorld* World)
+    {
+        const int32 Placements = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 4096;
+        const FIntPoint Sizes[] = { FIntPoint(10, 20), FIntPoint(10, 1000) };
+        const TArray<FTetrisSimShape>& Shapes = TetrisSimulation::GetStandardShapes();
+
+        for (const FIntPoint& Size : Sizes)
+        {
+            FTetrisBoardGrid Grid;
+            Grid.Init(Size.X, Size.Y);
+            const FTetrisBoardKernelOps& Ops = TetrisBoardKernels::Select(Size.X, Size.Y);
+
+            // The simulator picks placements; the grid replays them with the board's own operations
+            FTetrisSimBoard Sim;
+            Sim.Init(Size.X, Size.Y);
+            FTetrisSimScratch Scratch;
+            FRandomStream Random(1234);
+
+            FTetrisSnapshotRing Ring;
+            Ring.SetCapacity(Placements);
+            for (int32 Piece = 0; Piece < Placements; ++Piece)
+            {
+                FTetrisBoardSnapshot Snapshot;
+                Snapshot.Grid = Grid;
+                Snapshot.PieceNumber = Piece;
+                Ring.Push(MoveTemp(Snapshot));
+
+                const FTetrisSimShape& Shape = Shapes[Random.RandRange(0, Shapes.Num() - 1)];
+                const FTetrisSimPlacement Placement = TetrisSimulation::FindBestPlacement(Sim, Shape, FTetrisPlacementWeights(), Scratch);
+                if (!Placement.IsValid())
+                {
+                    Grid.Clear();
+                    Sim.Init(Size.X, Size.Y);
+                    continue;
+                }
+
+                const FTetrisSimRotation& Rotation = Shape.Rotations[Placement.Rotation];
+                for (int32 Row = 0; Row < Rotation.Height; ++Row)
+                {
+                    for (uint64 Bits = Rotation.RowBits[Row]; Bits; Bits &= Bits - 1)
+                    {
+                        Grid.SetOccupied(Placement.X + static_cast<int32>(FMath::CountTrailingZeros64(Bits)), Placement.Y + Row, true);
+                    }
+                }
+                Ops.ClearFullRows(Grid, Placement.Y, Placement.Y + Rotation.Height - 1);
+                Sim.Place(Rotation, Placement.X, Placement.Y);
+            }
+
+            // Restoring is what Undo/RewindTo do to the grid: rebuild from a keyframe, then a chunk-pointer copy
+            const int32 Restores = 10000;
+            int64 Sink = 0;
+            const double Start = FPlatformTime::Seconds();
+            for (int32 Index = 0; Index < Restores; ++Index)
+            {
+                const FTetrisBoardSnapshot* Snapshot = Ring.SeekTo(Random.RandRange(0, Placements - 1));
+                Grid = Snapshot->Grid;
+                Sink += Grid.GetRow(0)[0];
+            }
+            const double RestoreNs = (FPlatformTime::Seconds() - Start) * 1e9 / Restores;
+
+            const SIZE_T SharedBytes = Ring.GetAllocatedSize();
+            const SIZE_T FullCopyBytes = SIZE_T(Placements) * Grid.GetAllocatedSize();
+            UE_LOG(LogTemp, Display, TEXT("Tetris.BenchUndo %dx%d, %d placements: history %.1f KiB (full copies %.1f KiB), restore %.1f ns"),
+                Size.X, Size.Y, Placements, SharedBytes / 1024.0, FullCopyBytes / 1024.0, RestoreNs);
+            UE_LOG(LogTemp, Verbose, TEXT("Tetris.BenchUndo sink %lld"), Sink);
+
+            // The grid copy is the cheap half of a restore; redrawing the locked blocks is the rest
+            double RebuildUs = 0.0;
+            const int32 NumInstances = World ? TimeVisualRebuild(World, Size.X, Size.Y, 200, RebuildUs) : -1;
+            if (NumInstances >= 0)
+            {
+                UE_LOG(LogTemp, Display, TEXT("Tetris.BenchUndo %dx%d: visual rebuild %.1f us (%d instances)"),
+                    Size.X, Size.Y, RebuildUs, NumInstances);
+            }
+            else
+            {
+                UE_LOG(LogTemp, Display, TEXT("Tetris.BenchUndo %dx%d: no world or cube mesh, visual rebuild not timed"), Size.X, Size.Y);
+            }
+        }
+    }
+
+    static FAutoConsoleCommand BenchUndoCommand(
+        TEXT("Tetris.BenchUndo"),
+        TEXT("Measure undo history memory, snapshot restore time and the locked block rebuild a restore ends with. Optional arg: placements."),
+        FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunUndoBenchmark));
+
+    // Connect Count blocking loopback clients and wait until the server has accepted them all
+    static bool ConnectClients(const FTetrisSpectatorServer& Server, int32 Port, int32 Count, TArray<FSocket*>& OutClients)
+    {
+        ISocketSubsystem* Sockets = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+        TSharedRef<FInternetAddr> Address = Sockets->CreateInternetAddr();
+        Address->SetIp(0x7F000001);
+        Address->SetPort(Port);
+        for (int32 Index = 0; Index < Count; ++Index)
+        {
+            FSocket* Client = Sockets->CreateSocket(NAME_Stream, TEXT("TetrisBenchSpectator"), false);
+            if (!Client || !Client->Connect(*Address))
+            {
+                Sockets->DestroySocket(Client);
+                return false;
+            }
+            OutClients.Add(Client);
+        }
+
+        const double Deadline = FPlatformTime::Seconds() + 5.0;
+        while (Server.GetSubscriberCount() < Count && FPlatformTime::Seconds() < Deadline)
+        {
+            FPlatformProcess::Sleep(0.001f);
+        }
+        return Server.GetSubscriberCount() == Count;
+    }
+
+    static int64 DrainClients(const TArray<FSocket*>& Clients, TArray<uint8>& Buffer)
+    {
+        int64 Bytes = 0;
+        Buffer.SetNumUninitialized(64 * 1024);
+        for (FSocket* Client : Clients)
+        {
+            uint32 PendingBytes = 0;
+            int32 Read = 0;
+            while (Client->HasPendingData(PendingBytes) && Client->Recv(Buffer.GetData(), Buffer.Num(), Read) && Read > 0)
+            {
+                Bytes += Read;
+            }
+        }
+        return Bytes;
+    }
+
+    // Encode cost per frame should not depend on how many subscribers copy the frame out
+    static void RunSpectatorBenchmark(const TArray<FString>& Args)
+    {
+        const int32 NumFrames = Args.Num() > 0 && Args[0].IsNumeric() ? FMath::Max(1, FCString::Atoi(*Args[0])) : 2000;
+        const bool bTcp = Args.Contains(TEXT("tcp"));
+        const int32 Port = 17877;
+        const int32 SubscriberCounts[] = { 1, 16, 128, 512 };
+
+        for (const int32 NumSubscribers : SubscriberCounts)
+        {
+            TSharedRef<FTetrisSpectatorStream, ESPMode::ThreadSafe> Stream = MakeShared<FTetrisSpectatorStream, ESPMode::ThreadSafe>();
+            FTetrisBoardGrid Grid;
+            Grid.Init(10, 20);
+            TArray<uint8> Shadow;
+            Shadow.SetNumZeroed(TetrisSpectator::BytesPerRow(Grid.GetWidth()) * Grid.GetHeight());
+
+            // Subscribers join from this snapshot, as they would from the publisher's
+            TArray<uint8> Payload;
+            const uint16 Width = static_cast<uint16>(Grid.GetWidth());
+            const uint16 Height = static_cast<uint16>(Grid.GetHeight());
+            const int32 Score = 0;
+            Payload.Append(reinterpret_cast<const uint8*>(&Width), sizeof(Width));
+            Payload.Append(reinterpret_cast<const uint8*>(&Height), sizeof(Height));
+            Payload.Append(reinterpret_cast<const uint8*>(&Score), sizeof(Score));
+            Payload.Append(Shadow);
+            Payload.Add(0); // No active piece
+            Stream->SetSnapshot(Payload.GetData(), Payload.Num());
+
+            TArray<FTetrisSpectatorCursor> Cursors;
+            TUniquePtr<FTetrisSpectatorServer> Server;
+            TArray<FSocket*> Clients;
+            if (bTcp)
+            {
+                Server = MakeUnique<FTetrisSpectatorServer>(Stream, Port, NumSubscribers);
+                if (!Server->Start() || !ConnectClients(*Server, Port, NumSubscribers, Clients))
+                {
+                    UE_LOG(LogTemp, Warning, TEXT("Tetris.BenchSpectator - Could not connect %d loopback clients"), NumSubscribers);
+                    for (FSocket* Client : Clients)
+                    {
+                        ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Client);
+                    }
+                    continue;
+                }
+            }
+            else
+            {
+                Cursors.SetNum(NumSubscribers);
+            }
+
+            FRandomStream Random(1234);
+            TArray<uint8> Received;
+            uint64 EncodeCycles = 0;
+            uint64 FanOutCycles = 0;
+            int64 BytesDelivered = 0;
+            for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+            {
+                // A lock touches a couple of rows
+                const int32 Row = Random.RandRange(0, Grid.GetHeight() - 2);
+                for (int32 Y = Row; Y < Row + 2; ++Y)
+                {
+                    Grid.SetOccupied(Random.RandRange(0, Grid.GetWidth() - 1), Y, Random.FRand() < 0.5f);
+                }
+
+                const uint64 EncodeStart = FPlatformTime::Cycles64();
+                Payload.Reset();
+                if (TetrisSpectator::EncodeRowDiff(Grid, Row, Row + 1, Shadow, Payload) > 0)
+                {
+                    Stream->Append(ETetrisSpectatorFrame::RowsChanged, Payload.GetData(), Payload.Num());
+                }
+                EncodeCycles += FPlatformTime::Cycles64() - EncodeStart;
+
+                // In-process cursors copy on this thread; TCP fan-out runs on the server thread
+                const uint64 FanOutStart = FPlatformTime::Cycles64();
+                for (FTetrisSpectatorCursor& Cursor : Cursors)
+                {
+                    Received.Reset();
+                    Cursor.Poll(*Stream, Received);
+                    BytesDelivered += Received.Num();
+                }
+                BytesDelivered += DrainClients(Clients, Received);
+                FanOutCycles += FPlatformTime::Cycles64() - FanOutStart;
+            }
+
+            // Let the server finish sending before counting what arrived
+            const double Deadline = FPlatformTime::Seconds() + 1.0;
+            while (bTcp && FPlatformTime::Seconds() < Deadline)
+            {
+                BytesDelivered += DrainClients(Clients, Received);
+                FPlatformProcess::Sleep(0.01f);
+            }
+            for (FSocket* Client : Clients)
+            {
+                Client->Close();
+                ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Client);
+            }
+            Server.Reset();
+
+            UE_LOG(LogTemp, Display, TEXT("Tetris.BenchSpectator %s, %d subscribers, %d frames: encode %.1f ns/frame, %s %.1f ns/frame, %.1f KiB delivered"),
+                bTcp ? TEXT("tcp") : TEXT("cursors"), NumSubscribers, NumFrames,
+                FPlatformTime::ToSeconds64(EncodeCycles) * 1e9 / NumFrames,
+                bTcp ? TEXT("client drain") : TEXT("fan-out"), FPlatformTime::ToSeconds64(FanOutCycles) * 1e9 / NumFrames,
+                BytesDelivered / 1024.0);
+        }
+    }
+
+    static FAutoConsoleCommand BenchSpectatorCommand(
+        TEXT("Tetris.BenchSpectator"),
+        TEXT("Measure spectator encode time per frame against 1-512 subscribers. Optional args: frames, \"tcp\" for loopback sockets instead of in-process cursors."),
+        FConsoleCommandWithArgsDelegate::CreateStatic(&RunSpectatorBenchmark));
+}
@@ -1,9 +1,13 @@
 #include "TetrisBoard.h"
 #include "TetrisPiece.h"
 #include "TetrisPieceSpawner.h"
+#include "TetrisBoardKernels.h"
 #include "Kismet/GameplayStatics.h"
-
-#pragma optimize("", off)
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/LineBatchComponent.h"
+#include "DrawDebugHelpers.h"
+#include "Async/Async.h"
+#include "Misc/Paths.h"
 
 ATetrisBoard::ATetrisBoard()
 {
@@ -23,6 +27,14 @@ ATetrisBoard::ATetrisBoard()
     TopBoundary->SetupAttachment(BoardBounds);
     BottomBoundary->SetupAttachment(BoardBounds);
 
+    // All debug grid lines go through one batched component
+    DebugGridLines = CreateDefaultSubobject<ULineBatchComponent>(TEXT("DebugGridLines"));
+    DebugGridLines->SetupAttachment(BoardBounds);
+
+    LockedBlocks = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("LockedBlocks"));
+    LockedBlocks->SetupAttachment(BoardBounds);
+    LockedBlocks->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+
     // Default dimensions
     Width = 10;
     Height = 20;
@@ -58,36 +70,52 @@ void ATetrisBoard::UpdateBoundaries()
 
 void ATetrisBoard::DrawDebugGrid()
 {
-    if (!GetWorld()) return;
+    if (!GetWorld() || !DebugGridLines) return;
     
-    const float Duration = 0.0f; // Persistent debug drawing
     const float Thickness = 2.0f;
     const FColor LineColor = FColor::Green;
     const FColor TextColor = FColor::White;
+
+    // Keep labels readable (and cheap) on large boards
+    const int32 MaxLabelsPerAxis = 32;
+    const int32 ColumnLabelStride = FMath::Max(1, FMath::DivideAndRoundUp(Width + 1, MaxLabelsPerAxis));
+    const int32 RowLabelStride = FMath::Max(1, FMath::DivideAndRoundUp(Height + 1, MaxLabelsPerAxis));
+
+    TArray<FBatchedLine> Lines;
+    Lines.Reserve(Width + Height + 2);
     
-    // Draw vertical grid lines (top to bottom)
+    // Vertical grid lines (top to bottom)
     for (int32 x = 0; x <= Width; x++)
     {
         FVector Start = FVector(x * CellSize, 0, Height * CellSize);
         FVector End = FVector(x * CellSize, 0, 0);
-        DrawDebugLine(GetWorld(), Start, End, LineColor, false, Duration, 0, Thickness);
+        Lines.Emplace(Start, End, LineColor, 0.f, Thickness, SDPG_World);
         
         // Draw x index at top
-        FVector TextLoc = FVector(x * CellSize, 0, Height * CellSize + 50);
-        DrawDebugString(GetWorld(), TextLoc, FString::Printf(TEXT("%d"), x), nullptr, TextColor, Duration);
+        if (x % ColumnLabelStride == 0)
+        {
+            FVector TextLoc = FVector(x * CellSize, 0, Height * CellSize + CellSize / 2);
+            DrawDebugString(GetWorld(), TextLoc, FString::Printf(TEXT("%d"), x), nullptr, TextColor, 0.0f);
+        }
     }
     
-    // Draw horizontal grid lines (left to right)
+    // Horizontal grid lines (left to right)
     for (int32 y = 0; y <= Height; y++)
     {
         FVector Start = FVector(0, 0, Height * CellSize - y * CellSize);
         FVector End = FVector(Width * CellSize, 0, Height * CellSize - y * CellSize);
-        DrawDebugLine(GetWorld(), Start, End, LineColor, false, Duration, 0, Thickness);
+        Lines.Emplace(Start, End, LineColor, 0.f, Thickness, SDPG_World);
         
         // Draw y index at left
-        FVector TextLoc = FVector(-50, 0, Height * CellSize - y * CellSize);
-        DrawDebugString(GetWorld(), TextLoc, FString::Printf(TEXT("%d"), y), nullptr, TextColor, Duration);
+        if (y % RowLabelStride == 0)
+        {
+            FVector TextLoc = FVector(-CellSize / 2, 0, Height * CellSize - y * CellSize);
+            DrawDebugString(GetWorld(), TextLoc, FString::Printf(TEXT("%d"), y), nullptr, TextColor, 0.0f);
+        }
     }
+
+    DebugGridLines->Flush();
+    DebugGridLines->DrawLines(Lines);
 }
 
 void ATetrisBoard::Initialize()
@@ -100,23 +128,36 @@ void ATetrisBoard::Initialize()
     bIsInitialized = true;
 
     // Draw debug grid
-    DrawDebugGrid();
+    if (bDrawDebugGrid)
+    {
+        DrawDebugGrid();
+    }
     
-    // Initialize grid
-    Grid.SetNum(Height);
-    for(int32 y = 0; y < Height; y++)
+    // Initialize grid and pick the rules kernel for this geometry
+    Grid.Init(Width, Height);
+    Kernel = &TetrisBoardKernels::Select(Width, Height);
+
+    // Without instances the locked piece actors are the visuals, and a restore can't bring them back
+    if (UndoHistoryLimit > 0 && !HasLockedBlockVisuals())
     {
-        Grid[y].SetNum(Width);
-        for(int32 x = 0; x < Width; x++)
-        {
-            Grid[y][x] = false;
-        }
+        UE_LOG(LogTemp, Warning, TEXT("TetrisBoard::Initialize - LockedBlocks has no mesh, undo history disabled"));
+    }
+    UndoHistory.SetCapacity(HasLockedBlockVisuals() ? UndoHistoryLimit : 0);
+    NextPieceNumber = 0;
+
+    // A resume opens the journal itself once the old one has been read
+    if (bEnableJournal && !bResumingFromJournal)
+    {
+        Journal.Open(GetJournalPath(), 0.01f, JournalSyncInterval);
+        bJournalCheckpointDue = true;
     }
+    RebuildLockedBlockVisuals();
 
     UpdateBoundaries();
 
     // Broadcast initialization event
     OnBoardInitialized.Broadcast(Width, Height);
+    MarkBoardDirty();
 
     // Create spawner from specified class if none exists
     if (SpawnerClass && !Spawner)
@@ -154,41 +195,25 @@ bool ATetrisBoard::IsValidPosition(ATetrisPiece* Piece, FVector Offset) const
         return false;
     }
 
-    bool bIsValid = true;
-
-    if(!Piece) 
-    {
-        OnPieceMovementFailed.Broadcast(Offset);
-        return false;
-    }
-
+    TArray<FVector, TInlineAllocator<8>> BlockLocations;
+    TArray<FIntPoint, TInlineAllocator<8>> Cells;
     for(auto Block : Piece->Blocks)
     {
         if(!Block) continue;
 
         FVector BlockLocation = Block->GetComponentLocation() + Offset;
-        FVector2D GridPos = FVector2D(
-            FMath::RoundToInt(BlockLocation.X / 100.f),
-            FMath::RoundToInt(BlockLocation.Y / 100.f)
-        );
-
-        // Check bounds
-        if(GridPos.X < 0 || GridPos.X >= Width || GridPos.Y < 0)
-        {
-            OnPieceMovementFailed.Broadcast(BlockLocation + Offset);
-            bIsValid = false;
-            break;
-        }
+        BlockLocations.Add(BlockLocation);
+        Cells.Add(WorldToCell(BlockLocation));
+    }
 
-        // Check if already occupied (only check above visible board)
-        if(GridPos.Y < Height && Grid[GridPos.Y][GridPos.X])
-        {
-            OnPieceMovementFailed.Broadcast(BlockLocation + Offset);
-            bIsValid = false;
-            break;
-        }
+    // Bounds and occupancy (cells above the visible board only need to be within the walls)
+    const int32 Collision = Kernel->FindCollision(Grid, Cells.GetData(), Cells.Num());
+    if (Collision != INDEX_NONE)
+    {
+        OnPieceMovementFailed.Broadcast(BlockLocations[Collision] + Offset);
+        return false;
     }
-    return bIsValid;
+    return true;
 }
 
 void ATetrisBoard::LockPiece(ATetrisPiece* Piece)
@@ -205,26 +230,29 @@ void ATetrisBoard::LockPiece(ATetrisPiece* Piece)
         return;
     }
 
+    int32 MinRow = Height;
+    int32 MaxRow = -1;
+    TArray<FIntPoint, TInlineAllocator<8>> LockedCells;
     for (auto Block : Piece->Blocks)
     {
         if (!Block) continue;
 
         FVector BlockLocation = Block->GetComponentLocation();
-        FVector2D GridPos = FVector2D(
-            FMath::RoundToInt(BlockLocation.X / 100.f),
-            FMath::RoundToInt(BlockLocation.Y / 100.f)
-        );
+        FIntPoint GridPos = WorldToCell(BlockLocation);
 
-        // Check if the grid position is within the bounds of the visible board
-        if (GridPos.X >= 0 && GridPos.X < Width && GridPos.Y >= 0)
+        // Lock the block in place, ignoring anything outside the visible board
+        if (Grid.IsValid(GridPos.X, GridPos.Y))
         {
-            // Lock the block in place by setting the corresponding grid position to true
-            if (GridPos.Y < Height) // Only lock within the visible board height
-            {
-                Grid[GridPos.Y][GridPos.X] = true;
-            }
+            Grid.SetOccupied(GridPos.X, GridPos.Y, true);
+            LockedCells.Add(GridPos);
+            MinRow = FMath::Min(MinRow, GridPos.Y);
+            MaxRow = FMath::Max(MaxRow, GridPos.Y);
         }
     }
+    if (MinRow <= MaxRow)
+    {
+        OnRowsChanged.Broadcast(MinRow, MaxRow);
+    }
 
     // Broadcast piece locked event with position and rotation
     if(Piece)
@@ -232,89 +260,97 @@ void ATetrisBoard::LockPiece(ATetrisPiece* Piece)
         OnPieceLocked.Broadcast(Piece, Piece->GetActorLocation(), Piece->GetActorRotation());
     }
 
-    // After locking the piece, check for completed lines
-    CheckForCompletedLines();
+    // After locking the piece, check the rows it touched for completed lines
+    const int32 RowsCleared = ClearCompletedRows(MinRow, MaxRow);
+
+    Journal.WritePieceLocked(NextPieceNumber - 1, Spawner ? Spawner->GetState() : FTetrisSpawnerState(), LockedCells);
+
+    UpdateLockedBlockVisuals(MinRow, RowsCleared > 0 ? Height - 1 : MaxRow);
+    MarkBoardDirty();
 }
 
 void ATetrisBoard::CheckForCompletedLines()
 {
-    for (int Y = Height - 1; Y >= 0; --Y)
-    {
-        bool LineCompleted = true;
-
-        for (int X = 0; X < Width; ++X)
-        {
-            if (!Grid[Y][X])
-            {
-                LineCompleted = false;
-                break;
-            }
-        }
-
-        if (LineCompleted)
-        {
-            // Remove the completed line
-            for (int X = 0; X < Width; ++X)
-            {
-                Grid[Y][X] = false;
-            }
-
-            // Shift all lines above the completed line down by one
-            for (int CurrentY = Y; CurrentY < Height - 1; ++CurrentY)
-            {
-                for (int X = 0; X < Width; ++X)
-                {
-                    Grid[CurrentY][X] = Grid[CurrentY + 1][X];
-                }
-            }
+    ClearCompletedRows(0, Height - 1);
+}
 
-            // Optionally, update the score here
-            // UpdateScore();
-        }
+int32 ATetrisBoard::ClearCompletedRows(int32 MinRow, int32 MaxRow)
+{
+    const int32 RowsCleared = Kernel ? Kernel->ClearFullRows(Grid, MinRow, MaxRow) : 0;
+    if (RowsCleared > 0)
+    {
+        // Everything from the lowest candidate row up has shifted
+        OnRowsChanged.Broadcast(FMath::Max(MinRow, 0), Height - 1);
+        OnRowsCleared.Broadcast(RowsCleared);
     }
+    return RowsCleared;
 }
 
-
 int32 ATetrisBoard::ClearLines()
 {
-    int32 LinesCleared = 0;
-
-    for(int32 y = Height - 1; y >= 0; y--)
-    {
-        bool bLineComplete = true;
-        for(int32 x = 0; x < Width; x++)
-        {
-            if(!Grid[y][x])
-            {
-                bLineComplete = false;
-                break;
-            }
-        }
-
-        if(bLineComplete)
-        {
-            // Remove the line
-            Grid.RemoveAt(y);
-            // Add new empty line at top
-            Grid.Insert(TArray<bool>(), 0);
-            Grid[0].SetNum(Width);
-            
-            LinesCleared++;
-            y++; // Re-check current position as lines have shifted down
-        }
-    }
+    int32 LinesCleared = ClearCompletedRows(0, Height - 1);
 
     // Update score and broadcast lines cleared event
     if(LinesCleared > 0)
     {
         // Simple scoring - more points for more lines cleared at once
         CurrentScore += LinesCleared * LinesCleared * 100;
+        Journal.WriteLinesCleared(LinesCleared, CurrentScore);
         OnLinesCleared.Broadcast(LinesCleared, CurrentScore);
+        UpdateLockedBlockVisuals(0, Height - 1);
+        MarkBoardDirty();
     }
 
     return LinesCleared;
 }
 
+bool ATetrisBoard::AddGarbageRows(int32 Count, int32 HoleColumn)
+{
+    if (!bIsInitialized)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("TetrisBoard::AddGarbageRows - Board not initialized"));
+        return false;
+    }
+
+    // A full row could never be cleared, so every garbage row gets a hole; the chosen
+    // column is what gets journaled, so replay doesn't depend on the random pick
+    if (HoleColumn < 0 || HoleColumn >= Width)
+    {
+        HoleColumn = FMath::RandRange(0, Width - 1);
+    }
+
+    TArray<uint64, TInlineAllocator<4>> Row;
+    Row.SetNumUninitialized(Grid.GetWordsPerRow());
+    for (int32 Word = 0; Word < Row.Num(); ++Word)
+    {
+        Row[Word] = Grid.GetWordMask(Word);
+    }
+    Row[HoleColumn >> 6] &= ~(uint64(1) << (HoleColumn & 63));
+
+    bool bFits = true;
+    for (int32 Index = 0; Index < Count; ++Index)
+    {
+        bFits &= Grid.InsertRowAtBottom(Row.GetData());
+    }
+    Journal.WriteGarbage(Count, HoleColumn);
+    OnRowsChanged.Broadcast(0, Height - 1);
+
+    UpdateLockedBlockVisuals(0, Height - 1);
+    MarkBoardDirty();
+    if (!bFits)
+    {
+        EndGame();
+    }
+    return bFits;
+}
+
+void ATetrisBoard::EndGame()
+{
+    // A finished match must not be resumed from its journal
+    Journal.WriteGameOver(CurrentScore);
+    OnGameOver.Broadcast();
+}
+
 bool ATetrisBoard::TryMovePiece(ATetrisPiece* Piece, FVector Direction)
 {
     if (!bIsInitialized)
@@ -337,12 +373,18 @@ bool ATetrisBoard::TryMovePiece(ATetrisPiece* Piece, FVector Direction)
     bool bMoved = Piece->Move(Direction);
     if (bMoved)
     {
+        MarkBoardDirty();
         return true;
     }
     return false;
 }
 
 void ATetrisBoard::SpawnNewPiece()
+{
+    SpawnPiece(true);
+}
+
+void ATetrisBoard::SpawnPiece(bool bRecordSnapshot)
 {
     // Clear previous piece's event binding
     if(CurrentPiece)
@@ -353,22 +395,51 @@ void ATetrisBoard::SpawnNewPiece()
     if (!Spawner)
     {
         UE_LOG(LogTemp, Error, TEXT("TetrisBoard::SpawnNewPiece - No spawner available"));
-        OnGameOver.Broadcast();
+        EndGame();
         return;
     }
 
+    // Periodic checkpoints keep the journal, and so resume time, bounded
+    const bool bJournalCheckpoint = Journal.IsOpen() && (bJournalCheckpointDue || PiecesSinceCheckpoint >= JournalCheckpointInterval);
+    if ((bRecordSnapshot && UndoHistory.GetCapacity() > 0) || bJournalCheckpoint)
+    {
+        // The grid copy only shares chunk pointers; chunks are cloned when the live grid next writes them
+        FTetrisBoardSnapshot Snapshot;
+        Snapshot.Grid = Grid;
+        Snapshot.SpawnerState = Spawner->GetState();
+        Snapshot.Score = CurrentScore;
+        Snapshot.PieceNumber = NextPieceNumber;
+        if (bJournalCheckpoint)
+        {
+            Journal.WriteCheckpoint(Snapshot);
+            bJournalCheckpointDue = false;
+            PiecesSinceCheckpoint = 0;
+        }
+        if (bRecordSnapshot && UndoHistory.GetCapacity() > 0)
+        {
+            UndoHistory.Push(MoveTemp(Snapshot));
+        }
+    }
+    if (!bJournalCheckpoint)
+    {
+        Journal.WritePieceSpawned(NextPieceNumber, Spawner->GetState());
+    }
+    ++PiecesSinceCheckpoint;
+
     // Spawn new piece using board's spawner
     CurrentPiece = Spawner->SpawnNewPiece();
+    ++NextPieceNumber;
     
     // Check for game over (piece couldn't spawn in valid position)
     if(!CurrentPiece || !IsValidPosition(CurrentPiece))
     {
-        OnGameOver.Broadcast();
+        EndGame();
         return;
     }
 
     // Broadcast new piece spawned event
     OnNewPieceSpawned.Broadcast(CurrentPiece);
+    MarkBoardDirty();
 
     // Bind to the new piece's locked event
     CurrentPiece->OnPieceLocked.AddDynamic(this, &ATetrisBoard::HandlePieceLocked);
@@ -378,14 +449,400 @@ void ATetrisBoard::HandlePieceLocked()
 {
     if(!CurrentPiece) return;
     
-    // Lock the current piece
-    LockPiece(CurrentPiece);
-    
-    // Check for completed lines
-    CheckForCompletedLines();
+    // Lock the current piece (also clears any completed lines)
+    ATetrisPiece* LockedPiece = CurrentPiece;
+    LockPiece(LockedPiece);
     
     // Spawn a new piece
     SpawnNewPiece();
+
+    // Its blocks are drawn by the instanced mesh now
+    if (HasLockedBlockVisuals())
+    {
+        LockedPiece->Destroy();
+    }
+}
+
+bool ATetrisBoard::Undo()
+{
+    const FTetrisBoardSnapshot* Snapshot = bIsInitialized ? UndoHistory.StepBack() : nullptr;
+    if (!Snapshot)
+    {
+        return false;
+    }
+    RestoreSnapshot(*Snapshot);
+    return true;
+}
+
+bool ATetrisBoard::Redo()
+{
+    const FTetrisBoardSnapshot* Snapshot = bIsInitialized ? UndoHistory.StepForward() : nullptr;
+    if (!Snapshot)
+    {
+        return false;
+    }
+    RestoreSnapshot(*Snapshot);
+    return true;
+}
+
+bool ATetrisBoard::RewindToPiece(int32 PieceNumber)
+{
+    const FTetrisBoardSnapshot* Snapshot = bIsInitialized ? UndoHistory.SeekTo(PieceNumber) : nullptr;
+    if (!Snapshot)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("TetrisBoard::RewindToPiece - Piece %d is not in the history (%d-%d)"),
+            PieceNumber, UndoHistory.GetOldestPieceNumber(), UndoHistory.GetNewestPieceNumber());
+        return false;
+    }
+    RestoreSnapshot(*Snapshot);
+    return true;
+}
+
+bool ATetrisBoard::MakeSolverRequest(const TArray<ETetrisPieceShape>& Queue, ETetrisSolverGoal Goal, int32 LinesToClear, bool bFindAll,
+    float TimeBudgetSeconds, FTetrisSolverRequest& OutRequest) const
+{
+    if (!bIsInitialized || Grid.GetWidth() > 64)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("TetrisBoard::SolvePuzzle - Board must be initialized and at most 64 columns wide"));
+        return false;
+    }
+
+    OutRequest.Width = Grid.GetWidth();
+    OutRequest.Rows.SetNumUninitialized(Grid.GetHeight());
+    for (int32 Y = 0; Y < Grid.GetHeight(); ++Y)
+    {
+        OutRequest.Rows[Y] = Grid.GetRow(Y)[0];
+    }
+    OutRequest.Queue = Queue;
+    OutRequest.Goal = Goal;
+    OutRequest.LinesToClear = LinesToClear;
+    OutRequest.bFindAll = bFindAll;
+    OutRequest.TimeBudgetSeconds = TimeBudgetSeconds;
+    return true;
+}
+
+bool ATetrisBoard::SolvePuzzle(const TArray<ETetrisPieceShape>& Queue, ETetrisSolverGoal Goal, int32 LinesToClear, bool bFindAll,
+    float TimeBudgetSeconds, TArray<FTetrisSolution>& OutSolutions, bool& bTimedOut) const
+{
+    OutSolutions.Reset();
+    bTimedOut = false;
+    FTetrisSolverRequest Request;
+    if (!MakeSolverRequest(Queue, Goal, LinesToClear, bFindAll, TimeBudgetSeconds, Request))
+    {
+        return false;
+    }
+
+    FTetrisSolverResult Result = TetrisSolver::Solve(Request);
+    UE_LOG(LogTemp, Log, TEXT("TetrisBoard::SolvePuzzle - %d solution(s), %lld nodes, %lld memo hits, %lld pruned in %.3fs%s"),
+        Result.Solutions.Num(), Result.NodesVisited, Result.MemoHits, Result.Pruned, Result.Seconds, Result.bTimedOut ? TEXT(" (timed out)") : TEXT(""));
+
+    bTimedOut = Result.bTimedOut;
+    OutSolutions = MoveTemp(Result.Solutions);
+    return OutSolutions.Num() > 0;
+}
+
+bool ATetrisBoard::SolvePuzzleAsync(const TArray<ETetrisPieceShape>& Queue, ETetrisSolverGoal Goal, int32 LinesToClear, bool bFindAll,
+    float TimeBudgetSeconds, FOnPuzzleSolvedSignature OnSolved) const
+{
+    // The rows are copied here, so the search doesn't see pieces locked while it runs
+    FTetrisSolverRequest Request;
+    if (!MakeSolverRequest(Queue, Goal, LinesToClear, bFindAll, TimeBudgetSeconds, Request))
+    {
+        return false;
+    }
+
+    AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [Request = MoveTemp(Request), OnSolved]()
+    {
+        FTetrisSolverResult Result = TetrisSolver::Solve(Request);
+        UE_LOG(LogTemp, Log, TEXT("TetrisBoard::SolvePuzzleAsync - %d solution(s), %lld nodes in %.3fs%s"),
+            Result.Solutions.Num(), Result.NodesVisited, Result.Seconds, Result.bTimedOut ? TEXT(" (timed out)") : TEXT(""));
+
+        // The delegate only holds its object weakly, so a destroyed listener is skipped
+        AsyncTask(ENamedThreads::GameThread, [Result = MoveTemp(Result), OnSolved]()
+        {
+            OnSolved.ExecuteIfBound(Result.Solutions.Num() > 0, Result.Solutions, Result.bTimedOut);
+        });
+    });
+    return true;
+}
+
+void ATetrisBoard::RestoreSnapshot(const FTetrisBoardSnapshot& Snapshot)
+{
+    if (CurrentPiece)
+    {
+        CurrentPiece->OnPieceLocked.RemoveAll(this);
+        CurrentPiece->Destroy();
+        CurrentPiece = nullptr;
+    }
+
+    Grid = Snapshot.Grid;
+    OnRowsChanged.Broadcast(0, Height - 1);
+    CurrentScore = Snapshot.Score;
+    NextPieceNumber = Snapshot.PieceNumber;
+    if (Spawner)
+    {
+        Spawner->RestoreState(Snapshot.SpawnerState);
+    }
+
+    RebuildLockedBlockVisuals();
+
+    // The journal's records no longer lead to this state
+    bJournalCheckpointDue = true;
+
+    // Same spawner state, so this respawns the piece the snapshot was taken for
+    SpawnPiece(false);
+}
+
+bool ATetrisBoard::ResumeFromJournal()
+{
+    const double Start = FPlatformTime::Seconds();
+    const FString Path = GetJournalPath();
+
+    FTetrisBoardSnapshot State;
+    if (!FTetrisBoardJournal::Replay(Path, State))
+    {
+        UE_LOG(LogTemp, Log, TEXT("TetrisBoard::ResumeFromJournal - No usable journal at %s"), *Path);
+        return false;
+    }
+
+    Width = State.Grid.GetWidth();
+    Height = State.Grid.GetHeight();
+    {
+        TGuardValue<bool> ResumeGuard(bResumingFromJournal, true);
+        Initialize();
+    }
+    if (!bIsInitialized)
+    {
+        return false;
+    }
+
+    // The old journal stays in place until the checkpoint of the restored state replaces it
+    if (bEnableJournal)
+    {
+        Journal.Open(Path, 0.01f, JournalSyncInterval);
+    }
+    RestoreSnapshot(State);
+
+    UE_LOG(LogTemp, Display, TEXT("TetrisBoard::ResumeFromJournal - Resumed at piece %d, score %d in %.2fms"),
+        State.PieceNumber, State.Score, (FPlatformTime::Seconds() - Start) * 1000.0);
+    return true;
+}
+
+FString ATetrisBoard::GetJournalPath() const
+{
+    return FPaths::ProjectSavedDir() / TEXT("Journal") / (JournalName.IsEmpty() ? GetName() : JournalName) + TEXT(".tjl");
+}
+
+void ATetrisBoard::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    Journal.Close();
+    Super::EndPlay(EndPlayReason);
+}
+
+bool ATetrisBoard::HasLockedBlockVisuals() const
+{
+    return LockedBlocks && LockedBlocks->GetStaticMesh() != nullptr;
+}
+
+void ATetrisBoard::RebuildLockedBlockVisuals()
+{
+    if (!HasLockedBlockVisuals())
+    {
+        return;
+    }
+
+    // Engine cube meshes are 100 units across
+    const FVector Scale(CellSize / 100.f);
+    TArray<FTransform> Transforms;
+    DrawnRows.Reset();
+    CellInstances.Reset();
+    InstanceCells.Reset();
+    for (int32 Y = 0; Y < Grid.GetHeight(); ++Y)
+    {
+        const uint64* Row = Grid.GetRow(Y);
+        DrawnRows.Append(Row, Grid.GetWordsPerRow());
+        for (int32 Word = 0; Word < Grid.GetWordsPerRow(); ++Word)
+        {
+            for (uint64 Bits = Row[Word]; Bits; Bits &= Bits - 1)
+            {
+                const int32 X = Word * 64 + static_cast<int32>(FMath::CountTrailingZeros64(Bits));
+                Transforms.Emplace(FQuat::Identity, CellToWorld(FIntPoint(X, Y)), Scale);
+
+                // Instances are added below in this same order
+                const int32 Cell = Y * Width + X;
+                CellInstances.Add(Cell, InstanceCells.Add(Cell));
+            }
+        }
+    }
+
+    // One clear and one batched add, so a restore is a single render state update
+    LockedBlocks->ClearInstances();
+    LockedBlocks->AddInstances(Transforms, false, true);
+}
+
+void ATetrisBoard::UpdateLockedBlockVisuals(int32 MinRow, int32 MaxRow)
+{
+    if (!HasLockedBlockVisuals() || DrawnRows.Num() != Grid.GetHeight() * Grid.GetWordsPerRow())
+    {
+        RebuildLockedBlockVisuals();
+        return;
+    }
+
+    const FVector Scale(CellSize / 100.f);
+    auto CellTransform = [this, &Scale](int32 Cell)
+    {
+        return FTransform(FQuat::Identity, CellToWorld(FIntPoint(Cell % Width, Cell / Width)), Scale);
+    };
+
+    // Diff the rows against what is drawn
+    TArray<int32, TInlineAllocator<16>> AddedCells;
+    TArray<int32, TInlineAllocator<16>> FreedInstances;
+    const int32 WordsPerRow = Grid.GetWordsPerRow();
+    for (int32 Y = FMath::Max(MinRow, 0); Y <= FMath::Min(MaxRow, Height - 1); ++Y)
+    {
+        const uint64* Row = Grid.GetRow(Y);
+        uint64* Drawn = &DrawnRows[Y * WordsPerRow];
+        for (int32 Word = 0; Word < WordsPerRow; ++Word)
+        {
+            for (uint64 Bits = Row[Word] ^ Drawn[Word]; Bits; Bits &= Bits - 1)
+            {
+                const int32 Bit = static_cast<int32>(FMath::CountTrailingZeros64(Bits));
+                const int32 Cell = Y * Width + Word * 64 + Bit;
+                if (Row[Word] & (uint64(1) << Bit))
+                {
+                    AddedCells.Add(Cell);
+                }
+                else
+                {
+                    FreedInstances.Add(CellInstances.FindAndRemoveChecked(Cell));
+                }
+            }
+            Drawn[Word] = Row[Word];
+        }
+    }
+    if (AddedCells.Num() == 0 && FreedInstances.Num() == 0)
+    {
+        return;
+    }
+
+    // Move freed instances to new cells first, so most clears never resize the component
+    int32 NextAdded = 0;
+    for (; NextAdded < AddedCells.Num() && FreedInstances.Num() > 0; ++NextAdded)
+    {
+        const int32 Instance = FreedInstances.Pop(EAllowShrinking::No);
+        const int32 Cell = AddedCells[NextAdded];
+        LockedBlocks->UpdateInstanceTransform(Instance, CellTransform(Cell), true, false, true);
+        InstanceCells[Instance] = Cell;
+        CellInstances.Add(Cell, Instance);
+    }
+
+    if (NextAdded < AddedCells.Num())
+    {
+        TArray<FTransform> Transforms;
+        Transforms.Reserve(AddedCells.Num() - NextAdded);
+        for (; NextAdded < AddedCells.Num(); ++NextAdded)
+        {
+            const int32 Cell = AddedCells[NextAdded];
+            Transforms.Add(CellTransform(Cell));
+            CellInstances.Add(Cell, InstanceCells.Add(Cell));
+        }
+        LockedBlocks->AddInstances(Transforms, false, true);
+    }
+
+    // Fill the remaining holes from the end, highest first, so only the last instance is ever removed
+    FreedInstances.Sort(TGreater<int32>());
+    for (const int32 Instance : FreedInstances)
+    {
+        const int32 Last = InstanceCells.Num() - 1;
+        if (Instance != Last)
+        {
+            const int32 MovedCell = InstanceCells[Last];
+            LockedBlocks->UpdateInstanceTransform(Instance, CellTransform(MovedCell), true, false, true);
+            InstanceCells[Instance] = MovedCell;
+            CellInstances[MovedCell] = Instance;
+        }
+        InstanceCells.Pop(EAllowShrinking::No);
+        LockedBlocks->RemoveInstance(Last);
+    }
+
+    LockedBlocks->MarkRenderStateDirty();
+}
+
+FIntPoint ATetrisBoard::WorldToCell(const FVector& Location) const
+{
+    return FIntPoint(
+        FMath::RoundToInt(Location.X / CellSize),
+        FMath::RoundToInt(Location.Y / CellSize)
+    );
+}
+
+FVector ATetrisBoard::CellToWorld(const FIntPoint& Cell) const
+{
+    return FVector(Cell.X * CellSize, Cell.Y * CellSize, GetActorLocation().Z);
+}
+
+void ATetrisBoard::MarkBoardDirty()
+{
+    ++BoardRevision;
+    OnBoardRevisionChanged.Broadcast(BoardRevision);
 }
 
-#pragma optimize("", on)
\ No newline at end of file
+bool ATetrisBoard::IsCellOccupied(int32 X, int32 Y) const
+{
+    return bIsInitialized && Grid.IsOccupied(X, Y);
+}
+
+bool ATetrisBoard::GetPieceCells(ATetrisPiece* Piece, TArray<FIntPoint>& OutCells) const
+{
+    OutCells.Reset();
+    if (!Piece) return false;
+
+    for (auto Block : Piece->Blocks)
+    {
+        if (!Block) continue;
+        OutCells.Add(WorldToCell(Block->GetComponentLocation()));
+    }
+    return OutCells.Num() > 0;
+}
+
+bool ATetrisBoard::GetGhostCells(TArray<FIntPoint>& OutCells) const
+{
+    if (!bIsInitialized || !GetPieceCells(CurrentPiece, OutCells))
+    {
+        return false;
+    }
+
+    for (const FIntPoint& Cell : OutCells)
+    {
+        if (Cell.X < 0 || Cell.X >= Width)
+        {
+            return false;
+        }
+    }
+
+    // Walk the cells down one row at a time until the next step would collide
+    for (;;)
+    {
+        for (const FIntPoint& Cell : OutCells)
+        {
+            const int32 NextY = Cell.Y - 1;
+            if (NextY < 0 || (NextY < Height && Grid.IsOccupied(Cell.X, NextY)))
+            {
+                return true;
+            }
+        }
+        for (FIntPoint& Cell : OutCells)
+        {
+            --Cell.Y;
+        }
+    }
+}
+
+void ATetrisBoard::GetPreviewQueue(TArray<TSubclassOf<ATetrisPiece>>& OutQueue) const
+{
+    OutQueue.Reset();
+    if (Spawner && Spawner->GetNextPieceType())
+    {
+        OutQueue.Add(Spawner->GetNextPieceType());
+    }
+}
@@ -0,0 +1,427 @@
+#include "TetrisBoardEval.h"
+#include "TetrisBoard.h"
+
+#if PLATFORM_CPU_X86_FAMILY
+    #define TETRIS_EVAL_X86_SIMD 1
+    #include <immintrin.h>
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+        #define TETRIS_TARGET_SSE4
+        #define TETRIS_TARGET_AVX2
+    #else
+        #include <cpuid.h>
+        #define TETRIS_TARGET_SSE4 __attribute__((target("ssse3,sse4.1")))
+        #define TETRIS_TARGET_AVX2 __attribute__((target("avx2")))
+    #endif
+#else
+    #define TETRIS_EVAL_X86_SIMD 0
+#endif
+
+namespace TetrisBoardEval
+{
+    static uint64 RowMaskFor(int32 Width)
+    {
+        return Width >= 64 ? ~uint64(0) : (uint64(1) << Width) - 1;
+    }
+
+    /*
+     * All features come from one top-down pass over packed rows, keeping Seen = columns that
+     * have a block at or above the current row:
+     *   holes       = empty cells under Seen
+     *   height      = sum over rows of |Seen| (each column counts once per row below its top)
+     *   bumpiness   = sum over rows of |Seen(x) xor Seen(x+1)|
+     *   max height  = rows where Seen is non-empty
+     * so the same bit operations run unchanged across SIMD lanes, one board per lane.
+     */
+    static FTetrisBoardFeatures EvaluateScalar(const uint64* Rows, int32 Width, int32 Height)
+    {
+        const uint64 Mask = RowMaskFor(Width);
+        const uint64 PairMask = Mask >> 1;
+        const uint64 RightWall = uint64(1) << (Width - 1);
+
+        FTetrisBoardFeatures Out;
+        uint64 Seen = 0;
+        uint64 Prev = 0;
+        for (int32 Y = Height - 1; Y >= 0; --Y)
+        {
+            const uint64 R = Rows[Y] & Mask;
+            const uint64 Walls = ((R << 1) | 1) & ((R >> 1) | RightWall);
+
+            Out.Holes += FMath::CountBits(~R & Seen & Mask);
+            Out.WellDepthSum += FMath::CountBits(~R & ~Seen & Walls & Mask);
+            Out.ColumnTransitions += FMath::CountBits(R ^ Prev);
+            Prev = R;
+
+            Seen |= R;
+            Out.AggregateHeight += FMath::CountBits(Seen);
+            Out.Bumpiness += FMath::CountBits((Seen ^ (Seen >> 1)) & PairMask);
+            if (Seen != 0)
+            {
+                ++Out.MaxHeight;
+                Out.RowTransitions += FMath::CountBits((R ^ (R << 1) ^ 1) & Mask) + ((~R >> (Width - 1)) & 1);
+            }
+            Out.CompleteLines += R == Mask;
+        }
+        Out.ColumnTransitions += FMath::CountBits(~Prev & Mask);
+        return Out;
+    }
+
+#if TETRIS_EVAL_X86_SIMD
+    // Per-64-bit-lane popcount: nibble lookup with pshufb, then horizontal byte sums with psadbw
+    TETRIS_TARGET_SSE4 static inline __m128i PopCount128(__m128i V)
+    {
+        const __m128i Lut = _mm_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+        const __m128i Low = _mm_set1_epi8(0x0f);
+        const __m128i Lo = _mm_and_si128(V, Low);
+        const __m128i Hi = _mm_and_si128(_mm_srli_epi16(V, 4), Low);
+        const __m128i Bytes = _mm_add_epi8(_mm_shuffle_epi8(Lut, Lo), _mm_shuffle_epi8(Lut, Hi));
+        return _mm_sad_epu8(Bytes, _mm_setzero_si128());
+    }
+
+    TETRIS_TARGET_SSE4 static void EvaluateSSE4(const uint64* Rows, int32 Width, int32 Height, FTetrisBoardFeatures* Out)
+    {
+        const __m128i Zero = _mm_setzero_si128();
+        const __m128i One = _mm_set1_epi64x(1);
+        const __m128i AllOnes = _mm_set1_epi64x(-1);
+        const __m128i Mask = _mm_set1_epi64x(static_cast<int64>(RowMaskFor(Width)));
+        const __m128i PairMask = _mm_srli_epi64(Mask, 1);
+        const __m128i RightWall = _mm_set1_epi64x(static_cast<int64>(uint64(1) << (Width - 1)));
+        const __m128i RightShift = _mm_cvtsi32_si128(Width - 1);
+
+        __m128i Seen = Zero, Prev = Zero;
+        __m128i Holes = Zero, Wells = Zero, ColT = Zero, Agg = Zero, Bump = Zero, EmptyRows = Zero, RowT = Zero, Complete = Zero;
+
+        for (int32 Y = Height - 1; Y >= 0; --Y)
+        {
+            const __m128i R = _mm_and_si128(_mm_set_epi64x(static_cast<int64>(Rows[Height + Y]), static_cast<int64>(Rows[Y])), Mask);
+            const __m128i NotR = _mm_andnot_si128(R, Mask);
+            const __m128i Walls = _mm_and_si128(_mm_or_si128(_mm_slli_epi64(R, 1), One), _mm_or_si128(_mm_srli_epi64(R, 1), RightWall));
+
+            Holes = _mm_add_epi64(Holes, PopCount128(_mm_and_si128(NotR, Seen)));
+            Wells = _mm_add_epi64(Wells, PopCount128(_mm_andnot_si128(Seen, _mm_and_si128(NotR, Walls))));
+            ColT = _mm_add_epi64(ColT, PopCount128(_mm_xor_si128(R, Prev)));
+            Prev = R;
+
+            Seen = _mm_or_si128(Seen, R);
+            Agg = _mm_add_epi64(Agg, PopCount128(Seen));
+            Bump = _mm_add_epi64(Bump, PopCount128(_mm_and_si128(_mm_xor_si128(Seen, _mm_srli_epi64(Seen, 1)), PairMask)));
+
+            const __m128i IsEmpty = _mm_cmpeq_epi64(Seen, Zero);
+            EmptyRows = _mm_sub_epi64(EmptyRows, IsEmpty);
+            const __m128i Inner = PopCount128(_mm_and_si128(_mm_xor_si128(_mm_xor_si128(R, _mm_slli_epi64(R, 1)), One), Mask));
+            const __m128i Edge = _mm_and_si128(_mm_srl_epi64(_mm_xor_si128(R, AllOnes), RightShift), One);
+            RowT = _mm_add_epi64(RowT, _mm_andnot_si128(IsEmpty, _mm_add_epi64(Inner, Edge)));
+
+            Complete = _mm_sub_epi64(Complete, _mm_cmpeq_epi64(R, Mask));
+        }
+        ColT = _mm_add_epi64(ColT, PopCount128(_mm_andnot_si128(Prev, Mask)));
+
+        alignas(16) int64 Lanes[8][2];
+        _mm_store_si128(reinterpret_cast<__m128i*>(Lanes[0]), Agg);
+        _mm_store_si128(reinterpret_cast<__m128i*>(Lanes[1]), EmptyRows);
+        _mm_store_si128(reinterpret_cast<__m128i*>(Lanes[2]), Bump);
+        _mm_store_si128(reinterpret_cast<__m128i*>(Lanes[3]), Holes);
+        _mm_store_si128(reinterpret_cast<__m128i*>(Lanes[4]), RowT);
+        _mm_store_si128(reinterpret_cast<__m128i*>(Lanes[5]), ColT);
+        _mm_store_si128(reinterpret_cast<__m128i*>(Lanes[6]), Wells);
+        _mm_store_si128(reinterpret_cast<__m128i*>(Lanes[7]), Complete);
+        for (int32 Lane = 0; Lane < 2; ++Lane)
+        {
+            FTetrisBoardFeatures& F = Out[Lane];
+            F.AggregateHeight = static_cast<int32>(Lanes[0][Lane]);
+            F.MaxHeight = Height - static_cast<int32>(Lanes[1][Lane]);
+            F.Bumpiness = static_cast<int32>(Lanes[2][Lane]);
+            F.Holes = static_cast<int32>(Lanes[3][Lane]);
+            F.RowTransitions = static_cast<int32>(Lanes[4][Lane]);
+            F.ColumnTransitions = static_cast<int32>(Lanes[5][Lane]);
+            F.WellDepthSum = static_cast<int32>(Lanes[6][Lane]);
+            F.CompleteLines = static_cast<int32>(Lanes[7][Lane]);
+        }
+    }
+
+    TETRIS_TARGET_AVX2 static inline __m256i PopCount256(__m256i V)
+    {
+        const __m256i Lut = _mm256_setr_epi8(
+            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+        const __m256i Low = _mm256_set1_epi8(0x0f);
+        const __m256i Lo = _mm256_and_si256(V, Low);
+        const __m256i Hi = _mm256_and_si256(_mm256_srli_epi16(V, 4), Low);
+        const __m256i Bytes = _mm256_add_epi8(_mm256_shuffle_epi8(Lut, Lo), _mm256_shuffle_epi8(Lut, Hi));
+        return _mm256_sad_epu8(Bytes, _mm256_setzero_si256());
+    }
+
+    TETRIS_TARGET_AVX2 static void EvaluateAVX2(const uint64* Rows, int32 Width, int32 Height, FTetrisBoardFeatures* Out)
+    {
+        const __m256i Zero = _mm256_setzero_si256();
+        const __m256i One = _mm256_set1_epi64x(1);
+        const __m256i AllOnes = _mm256_set1_epi64x(-1);
+        const __m256i Mask = _mm256_set1_epi64x(static_cast<int64>(RowMaskFor(Width)));
+        const __m256i PairMask = _mm256_srli_epi64(Mask, 1);
+        const __m256i RightWall = _mm256_set1_epi64x(static_cast<int64>(uint64(1) << (Width - 1)));
+        const __m128i RightShift = _mm_cvtsi32_si128(Width - 1);
+
+        __m256i Seen = Zero, Prev = Zero;
+        __m256i Holes = Zero, Wells = Zero, ColT = Zero, Agg = Zero, Bump = Zero, EmptyRows = Zero, RowT = Zero, Complete = Zero;
+
+        for (int32 Y = Height - 1; Y >= 0; --Y)
+        {
+            const __m256i Loaded = _mm256_set_epi64x(
+                static_cast<int64>(Rows[3 * Height + Y]), static_cast<int64>(Rows[2 * Height + Y]),
+                static_cast<int64>(Rows[Height + Y]), static_cast<int64>(Rows[Y]));
+            const __m256i R = _mm256_and_si256(Loaded, Mask);
+            const __m256i NotR = _mm256_andnot_si256(R, Mask);
+            const __m256i Walls = _mm256_and_si256(_mm256_or_si256(_mm256_slli_epi64(R, 1), One), _mm256_or_si256(_mm256_srli_epi64(R, 1), RightWall));
+
+            Holes = _mm256_add_epi64(Holes, PopCount256(_mm256_and_si256(NotR, Seen)));
+            Wells = _mm256_add_epi64(Wells, PopCount256(_mm256_andnot_si256(Seen, _mm256_and_si256(NotR, Walls))));
+            ColT = _mm256_add_epi64(ColT, PopCount256(_mm256_xor_si256(R, Prev)));
+            Prev = R;
+
+            Seen = _mm256_or_si256(Seen, R);
+            Agg = _mm256_add_epi64(Agg, PopCount256(Seen));
+            Bump = _mm256_add_epi64(Bump, PopCount256(_mm256_and_si256(_mm256_xor_si256(Seen, _mm256_srli_epi64(Seen, 1)), PairMask)));
+
+            const __m256i IsEmpty = _mm256_cmpeq_epi64(Seen, Zero);
+            EmptyRows = _mm256_sub_epi64(EmptyRows, IsEmpty);
+            const __m256i Inner = PopCount256(_mm256_and_si256(_mm256_xor_si256(_mm256_xor_si256(R, _mm256_slli_epi64(R, 1)), One), Mask));
+            const __m256i Edge = _mm256_and_si256(_mm256_srl_epi64(_mm256_xor_si256(R, AllOnes), RightShift), One);
+            RowT = _mm256_add_epi64(RowT, _mm256_andnot_si256(IsEmpty, _mm256_add_epi64(Inner, Edge)));
+
+            Complete = _mm256_sub_epi64(Complete, _mm256_cmpeq_epi64(R, Mask));
+        }
+        ColT = _mm256_add_epi64(ColT, PopCount256(_mm256_andnot_si256(Prev, Mask)));
+
+        alignas(32) int64 Lanes[8][4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(Lanes[0]), Agg);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(Lanes[1]), EmptyRows);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(Lanes[2]), Bump);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(Lanes[3]), Holes);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(Lanes[4]), RowT);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(Lanes[5]), ColT);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(Lanes[6]), Wells);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(Lanes[7]), Complete);
+        for (int32 Lane = 0; Lane < 4; ++Lane)
+        {
+            FTetrisBoardFeatures& F = Out[Lane];
+            F.AggregateHeight = static_cast<int32>(Lanes[0][Lane]);
+            F.MaxHeight = Height - static_cast<int32>(Lanes[1][Lane]);
+            F.Bumpiness = static_cast<int32>(Lanes[2][Lane]);
+            F.Holes = static_cast<int32>(Lanes[3][Lane]);
+            F.RowTransitions = static_cast<int32>(Lanes[4][Lane]);
+            F.ColumnTransitions = static_cast<int32>(Lanes[5][Lane]);
+            F.WellDepthSum = static_cast<int32>(Lanes[6][Lane]);
+            F.CompleteLines = static_cast<int32>(Lanes[7][Lane]);
+        }
+    }
+
+    static void Cpuid(uint32 Leaf, uint32 SubLeaf, uint32 (&Regs)[4])
+    {
+    #if defined(_MSC_VER) && !defined(__clang__)
+        int32 Info[4];
+        __cpuidex(Info, Leaf, SubLeaf);
+        for (int32 Index = 0; Index < 4; ++Index)
+        {
+            Regs[Index] = static_cast<uint32>(Info[Index]);
+        }
+    #else
+        __cpuid_count(Leaf, SubLeaf, Regs[0], Regs[1], Regs[2], Regs[3]);
+    #endif
+    }
+
+    static uint64 ReadXCR0()
+    {
+    #if defined(_MSC_VER) && !defined(__clang__)
+        return _xgetbv(0);
+    #else
+        uint32 Lo = 0, Hi = 0;
+        __asm__ volatile("xgetbv" : "=a"(Lo), "=d"(Hi) : "c"(0));
+        return (uint64(Hi) << 32) | Lo;
+    #endif
+    }
+#endif // TETRIS_EVAL_X86_SIMD
+
+    static ETetrisSimdLevel DetectSimdLevel()
+    {
+    #if TETRIS_EVAL_X86_SIMD
+        uint32 Regs[4];
+        Cpuid(0, 0, Regs);
+        const uint32 MaxLeaf = Regs[0];
+
+        Cpuid(1, 0, Regs);
+        const bool bSSSE3 = (Regs[2] >> 9) & 1;
+        const bool bSSE41 = (Regs[2] >> 19) & 1;
+        const bool bOSXSave = (Regs[2] >> 27) & 1;
+        const bool bAVX = (Regs[2] >> 28) & 1;
+
+        bool bAVX2 = false;
+        if (MaxLeaf >= 7 && bOSXSave && bAVX && (ReadXCR0() & 0x6) == 0x6)
+        {
+            Cpuid(7, 0, Regs);
+            bAVX2 = (Regs[1] >> 5) & 1;
+        }
+
+        if (bAVX2)
+        {
+            return ETetrisSimdLevel::AVX2;
+        }
+        if (bSSSE3 && bSSE41)
+        {
+            return ETetrisSimdLevel::SSE4;
+        }
+    #endif
+        return ETetrisSimdLevel::Scalar;
+    }
+
+    ETetrisSimdLevel GetSupportedSimdLevel()
+    {
+        static const ETetrisSimdLevel Level = DetectSimdLevel();
+        return Level;
+    }
+
+    const TCHAR* LexToString(ETetrisSimdLevel Level)
+    {
+        switch (Level)
+        {
+        case ETetrisSimdLevel::SSE4: return TEXT("SSE4");
+        case ETetrisSimdLevel::AVX2: return TEXT("AVX2");
+        default: return TEXT("Scalar");
+        }
+    }
+
+    FTetrisBoardFeatures EvaluateBoard(const uint64* Rows, int32 Width, int32 Height)
+    {
+        check(Width > 0 && Width <= 64);
+        return EvaluateScalar(Rows, Width, Height);
+    }
+
+    void EvaluateBoards(const uint64* Rows, int32 NumBoards, int32 Width, int32 Height, FTetrisBoardFeatures* OutFeatures, ETetrisSimdLevel Level)
+    {
+        check(Width > 0 && Width <= 64);
+        Level = static_cast<ETetrisSimdLevel>(FMath::Min(static_cast<uint8>(Level), static_cast<uint8>(GetSupportedSimdLevel())));
+
+        int32 Board = 0;
+    #if TETRIS_EVAL_X86_SIMD
+        if (Level == ETetrisSimdLevel::AVX2)
+        {
+            for (; Board + 4 <= NumBoards; Board += 4)
+            {
+                EvaluateAVX2(Rows + Board * Height, Width, Height, OutFeatures + Board);
+            }
+        }
+        if (Level >= ETetrisSimdLevel::SSE4)
+        {
+            for (; Board + 2 <= NumBoards; Board += 2)
+            {
+                EvaluateSSE4(Rows + Board * Height, Width, Height, OutFeatures + Board);
+            }
+        }
+    #endif
+        for (; Board < NumBoards; ++Board)
+        {
+            OutFeatures[Board] = EvaluateScalar(Rows + Board * Height, Width, Height);
+        }
+    }
+
+    float Score(const FTetrisBoardFeatures& Features, const FTetrisPlacementWeights& Weights)
+    {
+        return Features.AggregateHeight * Weights.AggregateHeight
+            + Features.MaxHeight * Weights.MaxHeight
+            + Features.Bumpiness * Weights.Bumpiness
+            + Features.Holes * Weights.Holes
+            + Features.RowTransitions * Weights.RowTransitions
+            + Features.ColumnTransitions * Weights.ColumnTransitions
+            + Features.WellDepthSum * Weights.WellDepthSum
+            + Features.CompleteLines * Weights.CompleteLines;
+    }
+
+    int32 PickBestPlacement(const uint64* Rows, int32 NumBoards, int32 Width, int32 Height,
+        const FTetrisPlacementWeights& Weights, TArray<FTetrisBoardFeatures>& ScratchFeatures)
+    {
+        if (NumBoards <= 0)
+        {
+            return INDEX_NONE;
+        }
+
+        ScratchFeatures.SetNumUninitialized(NumBoards, EAllowShrinking::No);
+        EvaluateBoards(Rows, NumBoards, Width, Height, ScratchFeatures.GetData());
+
+        int32 Best = 0;
+        float BestScore = Score(ScratchFeatures[0], Weights);
+        for (int32 Board = 1; Board < NumBoards; ++Board)
+        {
+            const float BoardScore = Score(ScratchFeatures[Board], Weights);
+            if (BoardScore > BestScore)
+            {
+                Best = Board;
+                BestScore = BoardScore;
+            }
+        }
+        return Best;
+    }
+
+    // Copy a board's grid into one word per row, false if the board is too wide
+    static bool GatherRows(const ATetrisBoard* Board, TArray<uint64>& OutRows)
+    {
+        if (!Board)
+        {
+            return false;
+        }
+
+        const FTetrisBoardGrid& Grid = Board->GetGrid();
+        if (Grid.GetHeight() == 0 || Grid.GetWidth() > 64)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("TetrisBoardEval - Board must be initialized and at most 64 columns wide"));
+            return false;
+        }
+
+        OutRows.SetNumUninitialized(Grid.GetHeight());
+        for (int32 Y = 0; Y < Grid.GetHeight(); ++Y)
+        {
+            OutRows[Y] = Grid.GetRow(Y)[0];
+        }
+        return true;
+    }
+}
+
+FTetrisBoardFeatures UTetrisBoardEvalLibrary::EvaluateTetrisBoard(ATetrisBoard* Board)
+{
+    TArray<uint64> Rows;
+    if (!TetrisBoardEval::GatherRows(Board, Rows))
+    {
+        return FTetrisBoardFeatures();
+    }
+    return TetrisBoardEval::EvaluateBoard(Rows.GetData(), Board->GetGrid().GetWidth(), Rows.Num());
+}
+
+void UTetrisBoardEvalLibrary::GetColumnHeights(ATetrisBoard* Board, TArray<int32>& OutHeights)
+{
+    OutHeights.Reset();
+
+    TArray<uint64> Rows;
+    if (!TetrisBoardEval::GatherRows(Board, Rows))
+    {
+        return;
+    }
+
+    const int32 Width = Board->GetGrid().GetWidth();
+    OutHeights.SetNumZeroed(Width);
+
+    // Walk down from the top; the first row that sets a column fixes its height
+    uint64 Seen = 0;
+    for (int32 Y = Rows.Num() - 1; Y >= 0; --Y)
+    {
+        uint64 NewColumns = Rows[Y] & ~Seen & TetrisBoardEval::RowMaskFor(Width);
+        Seen |= NewColumns;
+        while (NewColumns)
+        {
+            OutHeights[FMath::CountTrailingZeros64(NewColumns)] = Y + 1;
+            NewColumns &= NewColumns - 1;
+        }
+    }
+}
+
+float UTetrisBoardEvalLibrary::ScoreFeatures(const FTetrisBoardFeatures& Features, const FTetrisPlacementWeights& Weights)
+{
+    return TetrisBoardEval::Score(Features, Weights);
+}
@@ -0,0 +1,304 @@
+#include "TetrisBoardGrid.h"
+#include "Algo/BinarySearch.h"
+
+void FTetrisBoardGrid::Init(int32 InWidth, int32 InHeight)
+{
+    Width = FMath::Max(InWidth, 1);
+    Height = FMath::Max(InHeight, 1);
+    WordsPerRow = (Width + 63) / 64;
+
+    const int32 TailBits = Width % 64;
+    LastWordMask = TailBits == 0 ? ~uint64(0) : (uint64(1) << TailBits) - 1;
+
+    Chunks.Reset();
+    for (int32 Start = 0; Start < Height; Start += ChunkRows)
+    {
+        FChunk& Chunk = *Chunks.Add_GetRef(MakeShared<FChunk>());
+        Chunk.NumRows = FMath::Min(ChunkRows, Height - Start);
+        Chunk.Words.SetNumZeroed(Chunk.NumRows * WordsPerRow);
+    }
+    RebuildChunkStarts();
+}
+
+void FTetrisBoardGrid::Clear()
+{
+    Init(Width, Height);
+}
+
+void FTetrisBoardGrid::RebuildChunkStarts()
+{
+    ChunkStarts.SetNumUninitialized(Chunks.Num());
+    int32 Start = 0;
+    for (int32 Index = 0; Index < Chunks.Num(); ++Index)
+    {
+        ChunkStarts[Index] = Start;
+        Start += Chunks[Index]->NumRows;
+    }
+}
+
+int32 FTetrisBoardGrid::LocateRow(int32 Y, int32& OutLocalRow) const
+{
+    // Last chunk whose start is <= Y
+    const int32 ChunkIndex = Algo::UpperBound(ChunkStarts, Y) - 1;
+    OutLocalRow = Y - ChunkStarts[ChunkIndex];
+    return ChunkIndex;
+}
+
+const uint64* FTetrisBoardGrid::GetRow(int32 Y) const
+{
+    check(Y >= 0 && Y < Height);
+    int32 LocalRow = 0;
+    const int32 ChunkIndex = LocateRow(Y, LocalRow);
+    return Chunks[ChunkIndex]->Words.GetData() + LocalRow * WordsPerRow;
+}
+
+FTetrisBoardGrid::FChunk& FTetrisBoardGrid::GetMutableChunk(int32 ChunkIndex)
+{
+    TSharedPtr<FChunk>& Chunk = Chunks[ChunkIndex];
+    if (!Chunk.IsUnique())
+    {
+        Chunk = MakeShared<FChunk>(*Chunk);
+    }
+    return *Chunk;
+}
+
+uint64* FTetrisBoardGrid::GetMutableRow(int32 Y)
+{
+    check(Y >= 0 && Y < Height);
+    int32 LocalRow = 0;
+    const int32 ChunkIndex = LocateRow(Y, LocalRow);
+    return GetMutableChunk(ChunkIndex).Words.GetData() + LocalRow * WordsPerRow;
+}
+
+uint64* FTetrisBoardGrid::GetMutableContiguousRows()
+{
+    return Chunks.Num() == 1 ? GetMutableChunk(0).Words.GetData() : nullptr;
+}
+
+bool FTetrisBoardGrid::IsOccupied(int32 X, int32 Y) const
+{
+    if (!IsValid(X, Y))
+    {
+        return false;
+    }
+    return (GetRow(Y)[X >> 6] >> (X & 63)) & 1;
+}
+
+void FTetrisBoardGrid::SetOccupied(int32 X, int32 Y, bool bOccupied)
+{
+    if (!IsValid(X, Y))
+    {
+        return;
+    }
+
+    uint64& Word = GetMutableRow(Y)[X >> 6];
+    const uint64 Bit = uint64(1) << (X & 63);
+    Word = bOccupied ? (Word | Bit) : (Word & ~Bit);
+}
+
+bool FTetrisBoardGrid::IsRowFull(int32 Y) const
+{
+    const uint64* Row = GetRow(Y);
+    for (int32 Word = 0; Word < WordsPerRow; ++Word)
+    {
+        if ((Row[Word] & GetWordMask(Word)) != GetWordMask(Word))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool FTetrisBoardGrid::IsRowEmpty(int32 Y) const
+{
+    const uint64* Row = GetRow(Y);
+    for (int32 Word = 0; Word < WordsPerRow; ++Word)
+    {
+        if (Row[Word] != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void FTetrisBoardGrid::InsertRowIntoChunk(int32 ChunkIndex, int32 LocalRow, const uint64* Words)
+{
+    FChunk& Chunk = GetMutableChunk(ChunkIndex);
+    Chunk.Words.InsertUninitialized(LocalRow * WordsPerRow, WordsPerRow);
+
+    uint64* Dest = Chunk.Words.GetData() + LocalRow * WordsPerRow;
+    if (Words)
+    {
+        FMemory::Memcpy(Dest, Words, WordsPerRow * sizeof(uint64));
+    }
+    else
+    {
+        FMemory::Memzero(Dest, WordsPerRow * sizeof(uint64));
+    }
+    ++Chunk.NumRows;
+}
+
+void FTetrisBoardGrid::RemoveRowFromChunk(int32 ChunkIndex, int32 LocalRow)
+{
+    FChunk& Chunk = GetMutableChunk(ChunkIndex);
+    Chunk.Words.RemoveAt(LocalRow * WordsPerRow, WordsPerRow, EAllowShrinking::No);
+    --Chunk.NumRows;
+}
+
+void FTetrisBoardGrid::Rebalance(int32 ChunkIndex)
+{
+    const int32 NumRows = Chunks[ChunkIndex]->NumRows;
+
+    if (NumRows >= 2 * ChunkRows)
+    {
+        // Move the upper half into a new chunk just above
+        FChunk& Chunk = GetMutableChunk(ChunkIndex);
+        const int32 KeepRows = NumRows / 2;
+        TSharedPtr<FChunk> Upper = MakeShared<FChunk>();
+        Upper->NumRows = NumRows - KeepRows;
+        Upper->Words.Append(Chunk.Words.GetData() + KeepRows * WordsPerRow, Upper->NumRows * WordsPerRow);
+        Chunk.Words.SetNum(KeepRows * WordsPerRow, EAllowShrinking::No);
+        Chunk.NumRows = KeepRows;
+        Chunks.Insert(MoveTemp(Upper), ChunkIndex + 1);
+        return;
+    }
+
+    if (Chunks.Num() == 1)
+    {
+        return;
+    }
+
+    if (NumRows == 0)
+    {
+        Chunks.RemoveAt(ChunkIndex);
+        return;
+    }
+
+    // Fold into whichever neighbour can take it without exceeding the target size
+    const int32 Neighbours[2] = { ChunkIndex - 1, ChunkIndex + 1 };
+    for (int32 Neighbour : Neighbours)
+    {
+        if (!Chunks.IsValidIndex(Neighbour) || Chunks[Neighbour]->NumRows + NumRows > ChunkRows)
+        {
+            continue;
+        }
+
+        const int32 Lower = FMath::Min(ChunkIndex, Neighbour);
+        FChunk& Into = GetMutableChunk(Lower);
+        const FChunk& From = *Chunks[Lower + 1];
+        Into.Words.Append(From.Words);
+        Into.NumRows += From.NumRows;
+        Chunks.RemoveAt(Lower + 1);
+        return;
+    }
+}
+
+void FTetrisBoardGrid::RemoveRow(int32 Y)
+{
+    if (Y < 0 || Y >= Height)
+    {
+        return;
+    }
+
+    int32 LocalRow = 0;
+    const int32 ChunkIndex = LocateRow(Y, LocalRow);
+    RemoveRowFromChunk(ChunkIndex, LocalRow);
+
+    // Empty row enters at the top of the board
+    const int32 TopChunk = Chunks.Num() - 1;
+    InsertRowIntoChunk(TopChunk, Chunks[TopChunk]->NumRows, nullptr);
+
+    // Rebalance the top first so ChunkIndex stays valid
+    Rebalance(TopChunk);
+    if (ChunkIndex != TopChunk && Chunks.IsValidIndex(ChunkIndex))
+    {
+        Rebalance(ChunkIndex);
+    }
+    RebuildChunkStarts();
+}
+
+bool FTetrisBoardGrid::InsertRowAtBottom(const uint64* Words)
+{
+    const bool bTopWasEmpty = IsRowEmpty(Height - 1);
+
+    const int32 TopChunk = Chunks.Num() - 1;
+    RemoveRowFromChunk(TopChunk, Chunks[TopChunk]->NumRows - 1);
+
+    InsertRowIntoChunk(0, 0, Words);
+    if (Words)
+    {
+        // Never let bits past Width leak into the board
+        uint64* Row = Chunks[0]->Words.GetData();
+        Row[WordsPerRow - 1] &= LastWordMask;
+    }
+
+    if (TopChunk != 0 && Chunks.IsValidIndex(TopChunk))
+    {
+        Rebalance(TopChunk);
+    }
+    Rebalance(0);
+    RebuildChunkStarts();
+
+    return bTopWasEmpty;
+}
+
+void FTetrisBoardGrid::GetChangedRows(const FTetrisBoardGrid& Base, TArray<int32>& OutRows) const
+{
+    OutRows.Reset();
+    if (Width != Base.Width || Height != Base.Height)
+    {
+        for (int32 Y = 0; Y < Height; ++Y)
+        {
+            OutRows.Add(Y);
+        }
+        return;
+    }
+
+    for (int32 ChunkIndex = 0; ChunkIndex < Chunks.Num(); ++ChunkIndex)
+    {
+        const FChunk& Chunk = *Chunks[ChunkIndex];
+        const int32 Start = ChunkStarts[ChunkIndex];
+
+        int32 BaseLocalRow = 0;
+        const int32 BaseChunk = Base.LocateRow(Start, BaseLocalRow);
+        if (BaseLocalRow == 0 && Base.Chunks[BaseChunk] == Chunks[ChunkIndex])
+        {
+            continue;
+        }
+
+        for (int32 LocalRow = 0; LocalRow < Chunk.NumRows; ++LocalRow)
+        {
+            const uint64* Row = Chunk.Words.GetData() + LocalRow * WordsPerRow;
+            if (FMemory::Memcmp(Row, Base.GetRow(Start + LocalRow), WordsPerRow * sizeof(uint64)) != 0)
+            {
+                OutRows.Add(Start + LocalRow);
+            }
+        }
+    }
+}
+
+SIZE_T FTetrisBoardGrid::GetAllocatedSize() const
+{
+    SIZE_T Size = Chunks.GetAllocatedSize() + ChunkStarts.GetAllocatedSize();
+    for (const TSharedPtr<FChunk>& Chunk : Chunks)
+    {
+        Size += sizeof(FChunk) + Chunk->Words.GetAllocatedSize();
+    }
+    return Size;
+}
+
+SIZE_T FTetrisBoardGrid::GetUniqueAllocatedSize(TSet<const void*>& SeenChunks) const
+{
+    SIZE_T Size = Chunks.GetAllocatedSize() + ChunkStarts.GetAllocatedSize();
+    for (const TSharedPtr<FChunk>& Chunk : Chunks)
+    {
+        bool bAlreadySeen = false;
+        SeenChunks.Add(Chunk.Get(), &bAlreadySeen);
+        if (!bAlreadySeen)
+        {
+            Size += sizeof(FChunk) + Chunk->Words.GetAllocatedSize();
+        }
+    }
+    return Size;
+}
@@ -0,0 +1,500 @@
+#include "TetrisBoardJournal.h"
+#include "TetrisPiece.h"
+#include "HAL/Event.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "UObject/SoftObjectPath.h"
+
+namespace TetrisBoardJournal
+{
+    constexpr int32 RecordHeaderSize = sizeof(uint32) + sizeof(uint32) + sizeof(uint8);
+
+    // Wake the writer early once this much is queued
+    constexpr int32 EagerWriteBytes = 256 * 1024;
+
+    static void SerializeSpawnerState(FArchive& Ar, FTetrisSpawnerState& State)
+    {
+        Ar << State.RandomSeed;
+        FString ClassPath = Ar.IsLoading() ? FString() : FSoftClassPath(State.NextPieceType.Get()).ToString();
+        Ar << ClassPath;
+        if (Ar.IsLoading())
+        {
+            State.NextPieceType = ClassPath.IsEmpty() ? nullptr : FSoftClassPath(ClassPath).TryLoadClass<ATetrisPiece>();
+        }
+    }
+
+    // Same result as the board's kernels: full rows in the range go, rows above drop
+    static void RemoveFullRows(FTetrisBoardGrid& Grid, int32 MinRow, int32 MaxRow)
+    {
+        for (int32 Y = FMath::Min(MaxRow, Grid.GetHeight() - 1); Y >= FMath::Max(MinRow, 0); --Y)
+        {
+            if (Grid.IsRowFull(Y))
+            {
+                Grid.RemoveRow(Y);
+            }
+        }
+    }
+}
+
+FTetrisBoardJournal::FTetrisBoardJournal()
+{
+}
+
+FTetrisBoardJournal::~FTetrisBoardJournal()
+{
+    Close();
+}
+
+bool FTetrisBoardJournal::Open(const FString& InPath, float InBatchInterval, float InSyncInterval)
+{
+    Close();
+
+    Path = InPath;
+    BatchInterval = FMath::Max(InBatchInterval, 0.001f);
+    SyncInterval = FMath::Max(InSyncInterval, 0.f);
+    if (!IFileManager::Get().MakeDirectory(*FPaths::GetPath(Path), true))
+    {
+        UE_LOG(LogTemp, Error, TEXT("TetrisBoardJournal::Open - Could not create the directory for %s"), *Path);
+        return false;
+    }
+
+    WakeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+    Thread = FRunnableThread::Create(this, TEXT("TetrisBoardJournal"), 0, TPri_BelowNormal);
+    if (!Thread)
+    {
+        FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+        WakeEvent = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void FTetrisBoardJournal::Close()
+{
+    if (!Thread)
+    {
+        return;
+    }
+
+    bStopping = true;
+    WakeEvent->Trigger();
+    Thread->WaitForCompletion();
+    delete Thread;
+    Thread = nullptr;
+
+    FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+    WakeEvent = nullptr;
+    File.Reset();
+    bStopping = false;
+}
+
+void FTetrisBoardJournal::Stop()
+{
+    bStopping = true;
+    if (WakeEvent)
+    {
+        WakeEvent->Trigger();
+    }
+}
+
+uint32 FTetrisBoardJournal::Run()
+{
+    while (!bStopping)
+    {
+        WakeEvent->Wait(FTimespan::FromSeconds(BatchInterval));
+        WritePending(false);
+    }
+    WritePending(true);
+    return 0;
+}
+
+void FTetrisBoardJournal::WritePending(bool bForceSync)
+{
+    int32 CheckpointOffset = INDEX_NONE;
+    {
+        FScopeLock Lock(&PendingLock);
+        Swap(Pending, Writing);
+        CheckpointOffset = PendingCheckpointOffset;
+        PendingCheckpointOffset = INDEX_NONE;
+    }
+
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    if (CheckpointOffset != INDEX_NONE)
+    {
+        // Everything before the checkpoint is superseded by it. The new file is synced before the
+        // swap, so a crash at any point leaves either the old journal or the new one intact.
+        const FString TempPath = Path + TEXT(".tmp");
+        TUniquePtr<IFileHandle> Temp(PlatformFile.OpenWrite(*TempPath));
+        bool bRotated = Temp && Temp->Write(Writing.GetData() + CheckpointOffset, Writing.Num() - CheckpointOffset) && Temp->Flush(true);
+        Temp.Reset();
+
+        File.Reset();
+        bRotated = bRotated && IFileManager::Get().Move(*Path, *TempPath, true, true);
+        if (bRotated)
+        {
+            File.Reset(PlatformFile.OpenWrite(*Path, true));
+            LastSyncTime = FPlatformTime::Seconds();
+            bUnsynced = false;
+        }
+        if (!File)
+        {
+            // Appending to the old file would pair new records with an old checkpoint; wait for the next one
+            UE_LOG(LogTemp, Error, TEXT("TetrisBoardJournal::WritePending - Failed to start %s, journaling paused until the next checkpoint"), *Path);
+        }
+    }
+    else if (File && Writing.Num() > 0)
+    {
+        if (File->Write(Writing.GetData(), Writing.Num()))
+        {
+            bUnsynced = true;
+        }
+        else
+        {
+            UE_LOG(LogTemp, Error, TEXT("TetrisBoardJournal::WritePending - Write to %s failed, journaling paused until the next checkpoint"), *Path);
+            File.Reset();
+        }
+    }
+    Writing.Reset();
+
+    const double Now = FPlatformTime::Seconds();
+    if (File && bUnsynced && (bForceSync || Now - LastSyncTime >= SyncInterval))
+    {
+        File->Flush(true);
+        LastSyncTime = Now;
+        bUnsynced = false;
+    }
+}
+
+void FTetrisBoardJournal::Submit(ETetrisJournalRecord Type)
+{
+    const uint32 PayloadSize = Scratch.Num();
+    const uint8 TypeByte = static_cast<uint8>(Type);
+    const uint32 Crc = FCrc::MemCrc32(Scratch.GetData(), Scratch.Num(), FCrc::MemCrc32(&TypeByte, sizeof(TypeByte)));
+
+    bool bWake = false;
+    {
+        FScopeLock Lock(&PendingLock);
+        if (Type == ETetrisJournalRecord::Checkpoint)
+        {
+            PendingCheckpointOffset = Pending.Num();
+        }
+
+        const int32 At = Pending.AddUninitialized(TetrisBoardJournal::RecordHeaderSize + PayloadSize);
+        uint8* Dest = Pending.GetData() + At;
+        FMemory::Memcpy(Dest, &PayloadSize, sizeof(PayloadSize));
+        FMemory::Memcpy(Dest + sizeof(uint32), &Crc, sizeof(Crc));
+        Dest[2 * sizeof(uint32)] = TypeByte;
+        FMemory::Memcpy(Dest + TetrisBoardJournal::RecordHeaderSize, Scratch.GetData(), PayloadSize);
+        bWake = Pending.Num() >= TetrisBoardJournal::EagerWriteBytes;
+    }
+
+    if (bWake && WakeEvent)
+    {
+        WakeEvent->Trigger();
+    }
+}
+
+void FTetrisBoardJournal::WriteCheckpoint(const FTetrisBoardSnapshot& State)
+{
+    if (!Thread)
+    {
+        return;
+    }
+
+    Scratch.Reset();
+    FMemoryWriter Ar(Scratch);
+    int32 Width = State.Grid.GetWidth();
+    int32 Height = State.Grid.GetHeight();
+    int32 Score = State.Score;
+    int32 PieceNumber = State.PieceNumber;
+    FTetrisSpawnerState SpawnerState = State.SpawnerState;
+    int32 WordsPerRow = State.Grid.GetWordsPerRow();
+    Ar << Width << Height << Score << PieceNumber;
+    TetrisBoardJournal::SerializeSpawnerState(Ar, SpawnerState);
+    Ar << WordsPerRow;
+    for (int32 Y = 0; Y < Height; ++Y)
+    {
+        Ar.Serialize(const_cast<uint64*>(State.Grid.GetRow(Y)), WordsPerRow * sizeof(uint64));
+    }
+    Submit(ETetrisJournalRecord::Checkpoint);
+}
+
+void FTetrisBoardJournal::WritePieceSpawned(int32 PieceNumber, const FTetrisSpawnerState& SpawnerState)
+{
+    if (!Thread)
+    {
+        return;
+    }
+
+    Scratch.Reset();
+    FMemoryWriter Ar(Scratch);
+    FTetrisSpawnerState State = SpawnerState;
+    Ar << PieceNumber;
+    TetrisBoardJournal::SerializeSpawnerState(Ar, State);
+    Submit(ETetrisJournalRecord::PieceSpawned);
+}
+
+void FTetrisBoardJournal::WritePieceLocked(int32 PieceNumber, const FTetrisSpawnerState& SpawnerState, TConstArrayView<FIntPoint> Cells)
+{
+    if (!Thread)
+    {
+        return;
+    }
+
+    Scratch.Reset();
+    FMemoryWriter Ar(Scratch);
+    FTetrisSpawnerState State = SpawnerState;
+    uint8 Count = static_cast<uint8>(FMath::Min(Cells.Num(), 255));
+    Ar << PieceNumber;
+    TetrisBoardJournal::SerializeSpawnerState(Ar, State);
+    Ar << Count;
+    for (int32 Index = 0; Index < Count; ++Index)
+    {
+        int16 X = static_cast<int16>(Cells[Index].X);
+        int16 Y = static_cast<int16>(Cells[Index].Y);
+        Ar << X << Y;
+    }
+    Submit(ETetrisJournalRecord::PieceLocked);
+}
+
+void FTetrisBoardJournal::WriteLinesCleared(int32 LinesCleared, int32 NewScore)
+{
+    if (!Thread)
+    {
+        return;
+    }
+
+    Scratch.Reset();
+    FMemoryWriter Ar(Scratch);
+    Ar << LinesCleared << NewScore;
+    Submit(ETetrisJournalRecord::LinesCleared);
+}
+
+void FTetrisBoardJournal::WriteGarbage(int32 Count, int32 HoleColumn)
+{
+    if (!Thread)
+    {
+        return;
+    }
+
+    Scratch.Reset();
+    FMemoryWriter Ar(Scratch);
+    Ar << Count << HoleColumn;
+    Submit(ETetrisJournalRecord::Garbage);
+}
+
+void FTetrisBoardJournal::WriteGameOver(int32 FinalScore)
+{
+    if (!Thread)
+    {
+        return;
+    }
+
+    Scratch.Reset();
+    FMemoryWriter Ar(Scratch);
+    Ar << FinalScore;
+    Submit(ETetrisJournalRecord::GameOver);
+}
+
+bool FTetrisBoardJournal::Replay(const FString& Path, FTetrisBoardSnapshot& OutState)
+{
+    using namespace TetrisBoardJournal;
+
+    TArray<uint8> Bytes;
+    if (!FFileHelper::LoadFileToArray(Bytes, *Path, FILEREAD_Silent))
+    {
+        return false;
+    }
+
+    bool bHaveCheckpoint = false;
+    bool bGameOver = false;
+    int32 NumRecords = 0;
+    int64 Offset = 0;
+    while (Offset + RecordHeaderSize <= Bytes.Num())
+    {
+        uint32 PayloadSize = 0;
+        uint32 Crc = 0;
+        FMemory::Memcpy(&PayloadSize, Bytes.GetData() + Offset, sizeof(PayloadSize));
+        FMemory::Memcpy(&Crc, Bytes.GetData() + Offset + sizeof(uint32), sizeof(Crc));
+        const uint8 TypeByte = Bytes[Offset + 2 * sizeof(uint32)];
+        const uint8* Payload = Bytes.GetData() + Offset + RecordHeaderSize;
+        if (Offset + RecordHeaderSize + int64(PayloadSize) > Bytes.Num()
+            || FCrc::MemCrc32(Payload, PayloadSize, FCrc::MemCrc32(&TypeByte, sizeof(TypeByte))) != Crc)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("TetrisBoardJournal::Replay - Torn record at byte %lld of %s, stopping there"), Offset, *Path);
+            break;
+        }
+
+        const ETetrisJournalRecord Type = static_cast<ETetrisJournalRecord>(TypeByte);
+        if (!bHaveCheckpoint && Type != ETetrisJournalRecord::Checkpoint)
+        {
+            break;
+        }
+
+        // Decode fully before touching OutState, so a bad record leaves the state as of the previous one
+        FMemoryReaderView Ar(MakeArrayView(Payload, PayloadSize));
+        bool bApplied = false;
+        switch (Type)
+        {
+        case ETetrisJournalRecord::Checkpoint:
+        {
+            int32 Width = 0;
+            int32 Height = 0;
+            int32 Score = 0;
+            int32 PieceNumber = 0;
+            int32 WordsPerRow = 0;
+            FTetrisSpawnerState SpawnerState;
+            Ar << Width << Height << Score << PieceNumber;
+            SerializeSpawnerState(Ar, SpawnerState);
+            Ar << WordsPerRow;
+            if (Ar.IsError() || Width <= 0 || Height <= 0 || WordsPerRow != (Width + 63) / 64
+                || Ar.TotalSize() - Ar.Tell() != int64(Height) * WordsPerRow * sizeof(uint64))
+            {
+                break;
+            }
+
+            OutState.Grid.Init(Width, Height);
+            for (int32 Y = 0; Y < Height; ++Y)
+            {
+                Ar.Serialize(OutState.Grid.GetMutableRow(Y), WordsPerRow * sizeof(uint64));
+            }
+            OutState.Score = Score;
+            OutState.PieceNumber = PieceNumber;
+            OutState.SpawnerState = SpawnerState;
+            bHaveCheckpoint = true;
+            bApplied = true;
+            break;
+        }
+        case ETetrisJournalRecord::PieceSpawned:
+        {
+            int32 PieceNumber = 0;
+            FTetrisSpawnerState SpawnerState;
+            Ar << PieceNumber;
+            SerializeSpawnerState(Ar, SpawnerState);
+            if (!Ar.IsError())
+            {
+                OutState.PieceNumber = PieceNumber;
+                OutState.SpawnerState = SpawnerState;
+                bApplied = true;
+            }
+            break;
+        }
+        case ETetrisJournalRecord::PieceLocked:
+        {
+            int32 PieceNumber = 0;
+            FTetrisSpawnerState SpawnerState;
+            uint8 Count = 0;
+            Ar << PieceNumber;
+            SerializeSpawnerState(Ar, SpawnerState);
+            Ar << Count;
+            TArray<FIntPoint, TInlineAllocator<8>> Cells;
+            for (int32 Index = 0; Index < Count; ++Index)
+            {
+                int16 X = 0;
+                int16 Y = 0;
+                Ar << X << Y;
+                Cells.Emplace(X, Y);
+            }
+            if (Ar.IsError())
+            {
+                break;
+            }
+
+            int32 MinRow = MAX_int32;
+            int32 MaxRow = -1;
+            for (const FIntPoint& Cell : Cells)
+            {
+                if (OutState.Grid.IsValid(Cell.X, Cell.Y))
+                {
+                    OutState.Grid.SetOccupied(Cell.X, Cell.Y, true);
+                    MinRow = FMath::Min(MinRow, Cell.Y);
+                    MaxRow = FMath::Max(MaxRow, Cell.Y);
+                }
+            }
+            RemoveFullRows(OutState.Grid, MinRow, MaxRow);
+
+            // The next spawn continues from the spawner state at lock time
+            OutState.PieceNumber = PieceNumber + 1;
+            OutState.SpawnerState = SpawnerState;
+            bApplied = true;
+            break;
+        }
+        case ETetrisJournalRecord::LinesCleared:
+        {
+            int32 LinesCleared = 0;
+            int32 NewScore = 0;
+            Ar << LinesCleared << NewScore;
+            if (!Ar.IsError())
+            {
+                RemoveFullRows(OutState.Grid, 0, OutState.Grid.GetHeight() - 1);
+                OutState.Score = NewScore;
+                bApplied = true;
+            }
+            break;
+        }
+        case ETetrisJournalRecord::Garbage:
+        {
+            int32 Count = 0;
+            int32 HoleColumn = 0;
+            Ar << Count << HoleColumn;
+            if (Ar.IsError())
+            {
+                break;
+            }
+
+            TArray<uint64, TInlineAllocator<4>> Row;
+            Row.SetNumUninitialized(OutState.Grid.GetWordsPerRow());
+            for (int32 Word = 0; Word < Row.Num(); ++Word)
+            {
+                Row[Word] = OutState.Grid.GetWordMask(Word);
+            }
+            if (HoleColumn >= 0 && HoleColumn < OutState.Grid.GetWidth())
+            {
+                Row[HoleColumn >> 6] &= ~(uint64(1) << (HoleColumn & 63));
+            }
+            for (int32 Index = 0; Index < Count; ++Index)
+            {
+                OutState.Grid.InsertRowAtBottom(Row.GetData());
+            }
+            bApplied = true;
+            break;
+        }
+        case ETetrisJournalRecord::GameOver:
+        {
+            int32 FinalScore = 0;
+            Ar << FinalScore;
+            if (!Ar.IsError())
+            {
+                OutState.Score = FinalScore;
+                bGameOver = true;
+                bApplied = true;
+            }
+            break;
+        }
+        default:
+            break;
+        }
+
+        if (!bApplied)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("TetrisBoardJournal::Replay - Unreadable record at byte %lld of %s, stopping there"), Offset, *Path);
+            break;
+        }
+        ++NumRecords;
+        Offset += RecordHeaderSize + PayloadSize;
+        if (bGameOver)
+        {
+            break;
+        }
+    }
+
+    UE_LOG(LogTemp, Log, TEXT("TetrisBoardJournal::Replay - %d records from %s%s"), NumRecords, *Path, bGameOver ? TEXT(", game already over") : TEXT(""));
+    return bHaveCheckpoint && !bGameOver;
+}
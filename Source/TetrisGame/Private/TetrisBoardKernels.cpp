@@ -0,0 +1,146 @@
+#include "TetrisBoardKernels.h"
+
+template <int32 InWidth, int32 InHeight>
+int32 TTetrisBoardKernel<InWidth, InHeight>::FindCollision(const FTetrisBoardGrid& Grid, const FIntPoint* Cells, int32 NumCells)
+{
+    const uint64* Rows = Grid.GetContiguousRows();
+    check(Rows && Grid.GetWidth() == InWidth && Grid.GetHeight() == InHeight);
+
+    for (int32 Index = 0; Index < NumCells; ++Index)
+    {
+        const int32 X = Cells[Index].X;
+        const int32 Y = Cells[Index].Y;
+        if (static_cast<uint32>(X) >= static_cast<uint32>(InWidth) || Y < 0)
+        {
+            return Index;
+        }
+        if (Y < InHeight && ((Rows[Y] >> X) & 1))
+        {
+            return Index;
+        }
+    }
+    return INDEX_NONE;
+}
+
+template <int32 InWidth, int32 InHeight>
+int32 TTetrisBoardKernel<InWidth, InHeight>::ClearFullRows(FTetrisBoardGrid& Grid, int32 MinRow, int32 MaxRow)
+{
+    const uint64* ReadRows = Grid.GetContiguousRows();
+    check(ReadRows && Grid.GetWidth() == InWidth && Grid.GetHeight() == InHeight);
+
+    const int32 Lo = FMath::Max(MinRow, 0);
+    const int32 Hi = FMath::Min(MaxRow, InHeight - 1);
+    if (Lo > Hi)
+    {
+        return 0;
+    }
+
+    // One bit per full row; the fixed trip count lets this loop unroll and vectorize
+    uint64 FullBits = 0;
+    for (int32 Y = 0; Y < InHeight; ++Y)
+    {
+        FullBits |= uint64((ReadRows[Y] & FullRowMask) == FullRowMask) << Y;
+    }
+
+    const int32 RangeRows = Hi - Lo + 1;
+    const uint64 RangeMask = (RangeRows == 64 ? ~uint64(0) : (uint64(1) << RangeRows) - 1) << Lo;
+    FullBits &= RangeMask;
+    if (FullBits == 0)
+    {
+        return 0;
+    }
+
+    // Only take write access once something clears; writing would unshare a snapshotted chunk
+    uint64* Rows = Grid.GetMutableContiguousRows();
+
+    // Compact surviving rows down over the cleared ones, then empty the top
+    int32 Write = static_cast<int32>(FMath::CountTrailingZeros64(FullBits));
+    for (int32 Y = Write; Y < InHeight; ++Y)
+    {
+        if (((FullBits >> Y) & 1) == 0)
+        {
+            Rows[Write++] = Rows[Y];
+        }
+    }
+
+    const int32 Cleared = InHeight - Write;
+    for (; Write < InHeight; ++Write)
+    {
+        Rows[Write] = 0;
+    }
+    return Cleared;
+}
+
+int32 FTetrisGenericBoardKernel::FindCollision(const FTetrisBoardGrid& Grid, const FIntPoint* Cells, int32 NumCells)
+{
+    const int32 Width = Grid.GetWidth();
+    const int32 Height = Grid.GetHeight();
+
+    for (int32 Index = 0; Index < NumCells; ++Index)
+    {
+        const FIntPoint& Cell = Cells[Index];
+        if (Cell.X < 0 || Cell.X >= Width || Cell.Y < 0)
+        {
+            return Index;
+        }
+        if (Cell.Y < Height && Grid.IsOccupied(Cell.X, Cell.Y))
+        {
+            return Index;
+        }
+    }
+    return INDEX_NONE;
+}
+
+int32 FTetrisGenericBoardKernel::ClearFullRows(FTetrisBoardGrid& Grid, int32 MinRow, int32 MaxRow)
+{
+    int32 Cleared = 0;
+
+    // Walk top-down so removing a row never shifts a row we still have to check
+    for (int32 Y = FMath::Min(MaxRow, Grid.GetHeight() - 1); Y >= FMath::Max(MinRow, 0); --Y)
+    {
+        if (Grid.IsRowFull(Y))
+        {
+            Grid.RemoveRow(Y);
+            ++Cleared;
+        }
+    }
+    return Cleared;
+}
+
+template struct TTetrisBoardKernel<10, 20>;
+template struct TTetrisBoardKernel<10, 40>;
+template struct TTetrisBoardKernel<4, 20>;
+template struct TTetrisBoardKernel<6, 20>;
+
+namespace TetrisBoardKernels
+{
+    template <int32 InWidth, int32 InHeight>
+    static const FTetrisBoardKernelOps& OpsFor(const TCHAR* Name)
+    {
+        static const FTetrisBoardKernelOps Ops = {
+            &TTetrisBoardKernel<InWidth, InHeight>::FindCollision,
+            &TTetrisBoardKernel<InWidth, InHeight>::ClearFullRows,
+            Name
+        };
+        return Ops;
+    }
+
+    const FTetrisBoardKernelOps& Generic()
+    {
+        static const FTetrisBoardKernelOps Ops = {
+            &FTetrisGenericBoardKernel::FindCollision,
+            &FTetrisGenericBoardKernel::ClearFullRows,
+            TEXT("Generic")
+        };
+        return Ops;
+    }
+
+    const FTetrisBoardKernelOps& Select(int32 Width, int32 Height)
+    {
+        if (Width == 10 && Height == 20) return OpsFor<10, 20>(TEXT("10x20"));
+        if (Width == 10 && Height == 40) return OpsFor<10, 40>(TEXT("10x40"));
+        if (Width == 4 && Height == 20) return OpsFor<4, 20>(TEXT("4x20"));
+        if (Width == 6 && Height == 20) return OpsFor<6, 20>(TEXT("6x20"));
+        return Generic();
+    }
+}
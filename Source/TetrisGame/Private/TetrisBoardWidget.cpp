@@ -0,0 +1,60 @@
+#include "TetrisBoardWidget.h"
+#include "STetrisBoardWidget.h"
+#include "TetrisBoard.h"
+
+#define LOCTEXT_NAMESPACE "TetrisBoardWidget"
+
+void UTetrisBoardWidget::SetBoard(ATetrisBoard* InBoard)
+{
+    Board = InBoard;
+    if (MyBoardWidget.IsValid())
+    {
+        MyBoardWidget->SetBoard(InBoard);
+    }
+}
+
+TSharedRef<SWidget> UTetrisBoardWidget::RebuildWidget()
+{
+    MyBoardWidget = SNew(STetrisBoardWidget)
+        .Board(Board)
+        .DesiredCellSize(DesiredCellSize)
+        .PreviewColumns(PreviewColumns);
+    return MyBoardWidget.ToSharedRef();
+}
+
+void UTetrisBoardWidget::SynchronizeProperties()
+{
+    Super::SynchronizeProperties();
+
+    if (!MyBoardWidget.IsValid())
+    {
+        return;
+    }
+
+    STetrisBoardWidget::FPalette Palette;
+    Palette.Background = BackgroundColor;
+    Palette.Locked = LockedColor;
+    Palette.Active = ActiveColor;
+    Palette.Ghost = GhostColor;
+    Palette.Preview = PreviewColor;
+
+    MyBoardWidget->SetPalette(Palette);
+    MyBoardWidget->SetDesiredCellSize(DesiredCellSize);
+    MyBoardWidget->SetPreviewColumns(PreviewColumns);
+    MyBoardWidget->SetBoard(Board);
+}
+
+void UTetrisBoardWidget::ReleaseSlateResources(bool bReleaseChildren)
+{
+    Super::ReleaseSlateResources(bReleaseChildren);
+    MyBoardWidget.Reset();
+}
+
+#if WITH_EDITOR
+const FText UTetrisBoardWidget::GetPaletteCategory()
+{
+    return LOCTEXT("Tetris", "Tetris");
+}
+#endif
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,168 @@
+#include "TetrisBotComponent.h"
+#include "TetrisBoard.h"
+#include "TetrisBotWeights.h"
+#include "TetrisPiece.h"
+#include "TimerManager.h"
+
+UTetrisBotComponent::UTetrisBotComponent()
+{
+    PrimaryComponentTick.bCanEverTick = false;
+}
+
+void UTetrisBotComponent::BeginPlay()
+{
+    Super::BeginPlay();
+
+    if (UTetrisBotWeights* Loaded = WeightsAsset.LoadSynchronous())
+    {
+        Weights = Loaded->Weights;
+    }
+    else if (!WeightsAsset.IsNull())
+    {
+        UE_LOG(LogTemp, Warning, TEXT("TetrisBotComponent::BeginPlay - Could not load %s, using default weights"), *WeightsAsset.ToString());
+    }
+
+    Board = Cast<ATetrisBoard>(GetOwner());
+    if (Board)
+    {
+        Board->OnNewPieceSpawned.AddDynamic(this, &UTetrisBotComponent::HandleNewPieceSpawned);
+    }
+}
+
+void UTetrisBotComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (UWorld* World = GetWorld())
+    {
+        World->GetTimerManager().ClearTimer(PlacementTimerHandle);
+    }
+
+    if (Board)
+    {
+        Board->OnNewPieceSpawned.RemoveAll(this);
+    }
+
+    Super::EndPlay(EndPlayReason);
+}
+
+void UTetrisBotComponent::HandleNewPieceSpawned(ATetrisPiece* NewPiece)
+{
+    if (!bEnabled)
+    {
+        return;
+    }
+
+    // Never place from inside the spawn broadcast: placing locks the piece, which spawns the next one
+    FTimerManager& TimerManager = GetWorld()->GetTimerManager();
+    if (PlacementDelay > 0.f)
+    {
+        TimerManager.SetTimer(PlacementTimerHandle, this, &UTetrisBotComponent::PlayCurrentPiece, PlacementDelay, false);
+    }
+    else
+    {
+        PlacementTimerHandle = TimerManager.SetTimerForNextTick(this, &UTetrisBotComponent::PlayCurrentPiece);
+    }
+}
+
+void UTetrisBotComponent::PlayCurrentPiece()
+{
+    ATetrisPiece* Piece = Board ? Board->CurrentPiece : nullptr;
+    if (!Piece)
+    {
+        return;
+    }
+
+    const FTetrisBoardGrid& Grid = Board->GetGrid();
+    if (Grid.GetHeight() == 0 || Grid.GetWidth() > 64)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("TetrisBotComponent::PlayCurrentPiece - Board must be initialized and at most 64 columns wide"));
+        return;
+    }
+
+    // Sample the live piece in each orientation, so custom piece classes work too.
+    // Four quarter turns bring it back to where it started.
+    FTetrisSimShape Shape;
+    TArray<int32, TInlineAllocator<4>> TurnsForRotation;
+    TArray<FIntPoint> Cells;
+    for (int32 Turn = 0; Turn < 4; ++Turn)
+    {
+        if (Board->GetPieceCells(Piece, Cells))
+        {
+            const int32 RotationIndex = Shape.AddRotation(Cells.GetData(), Cells.Num());
+            if (RotationIndex == TurnsForRotation.Num())
+            {
+                TurnsForRotation.Add(Turn);
+            }
+        }
+        Piece->Rotate();
+    }
+
+    SimBoard.Init(Grid.GetWidth(), Grid.GetHeight());
+    TArray<uint64> Rows;
+    Rows.SetNumUninitialized(Grid.GetHeight());
+    for (int32 Y = 0; Y < Grid.GetHeight(); ++Y)
+    {
+        Rows[Y] = Grid.GetRow(Y)[0];
+    }
+    SimBoard.SetRows(Rows.GetData());
+
+    const FTetrisSimPlacement Placement = TetrisSimulation::FindBestPlacement(SimBoard, Shape, Weights, Scratch);
+    if (!Placement.IsValid())
+    {
+        return;
+    }
+
+    // Turn one step at a time like a player would; if a turn collides, put the piece back
+    // (four quarter turns are a full circle) and drop it as it spawned
+    const int32 Turns = TurnsForRotation[Placement.Rotation];
+    for (int32 Turn = 0; Turn < Turns; ++Turn)
+    {
+        Piece->Rotate();
+        if (!Board->IsValidPosition(Piece))
+        {
+            for (int32 Undo = Turn + 1; Undo < 4; ++Undo)
+            {
+                Piece->Rotate();
+            }
+            UE_LOG(LogTemp, Verbose, TEXT("TetrisBotComponent::PlayCurrentPiece - Rotation blocked, dropping unrotated"));
+            break;
+        }
+    }
+    Board->MarkBoardDirty();
+
+    // Slide towards the target column one cell at a time, stopping if something is in the way
+    auto GetMinColumn = [this, Piece, &Cells]()
+    {
+        int32 MinX = MAX_int32;
+        Board->GetPieceCells(Piece, Cells);
+        for (const FIntPoint& Cell : Cells)
+        {
+            MinX = FMath::Min(MinX, Cell.X);
+        }
+        return MinX;
+    };
+
+    const FVector Right = Board->GetActorForwardVector();
+    for (int32 MinX = GetMinColumn(); MinX != Placement.X; )
+    {
+        if (!Board->TryMovePiece(Piece, MinX < Placement.X ? Right : -Right))
+        {
+            break;
+        }
+        const int32 NewMinX = GetMinColumn();
+        if (NewMinX == MinX)
+        {
+            break;
+        }
+        MinX = NewMinX;
+    }
+
+    // WorldToCell maps world Y to rows, so that is the axis to drop along. The piece can fall
+    // at most the height of the board, which also bounds the loop if that ever changes.
+    const FVector Down(0.f, -1.f, 0.f);
+    for (int32 Step = 0; Step < Grid.GetHeight() && Board->TryMovePiece(Piece, Down); ++Step)
+    {
+    }
+
+    // Locks, clears and spawns the next piece, which schedules the next placement
+    Board->HandlePieceLocked();
+}
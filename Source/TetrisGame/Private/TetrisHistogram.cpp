@@ -0,0 +1,40 @@
+#include "TetrisHistogram.h"
+
+FTetrisHistogram::FSummary FTetrisHistogram::Summarize() const
+{
+    FSummary Summary;
+
+    uint64 Counts[NumBuckets];
+    uint64 Total = 0;
+    for (int32 Bucket = 0; Bucket < NumBuckets; ++Bucket)
+    {
+        Counts[Bucket] = Buckets[Bucket].load(std::memory_order_relaxed);
+        Total += Counts[Bucket];
+    }
+
+    Summary.Count = Total;
+    Summary.Sum = Sum.load(std::memory_order_relaxed);
+    Summary.Max = Max.load(std::memory_order_relaxed);
+    if (Total == 0)
+    {
+        return Summary;
+    }
+    Summary.Mean = double(Summary.Sum) / double(Total);
+
+    // Walk the cumulative counts once, filling each percentile as it is crossed
+    const uint64 Targets[3] = { (Total * 50 + 99) / 100, (Total * 90 + 99) / 100, (Total * 99 + 99) / 100 };
+    uint64* Outputs[3] = { &Summary.P50, &Summary.P90, &Summary.P99 };
+    int32 NextTarget = 0;
+    uint64 Running = 0;
+    for (int32 Bucket = 0; Bucket < NumBuckets && NextTarget < 3; ++Bucket)
+    {
+        Running += Counts[Bucket];
+        while (NextTarget < 3 && Running >= Targets[NextTarget])
+        {
+            *Outputs[NextTarget] = FMath::Min(BucketUpperBound(Bucket), Summary.Max);
+            ++NextTarget;
+        }
+    }
+
+    return Summary;
+}
@@ -19,3 +19,21 @@ void ATetrisPiece::Rotate()
     FRotator Rotation(0, 90, 0);
     AddActorWorldRotation(Rotation);
 }
+
+void ATetrisPiece::GetPreviewCells(TArray<FIntPoint>& OutCells) const
+{
+    if (PreviewCells.Num() > 0 || BlockSize <= 0.f)
+    {
+        OutCells = PreviewCells;
+        return;
+    }
+
+    // Same axes the board maps world locations to cells with
+    OutCells.Reset();
+    for (const UStaticMeshComponent* Block : Blocks)
+    {
+        if (!Block) continue;
+        const FVector Location = Block->GetRelativeLocation();
+        OutCells.Add(FIntPoint(FMath::RoundToInt(Location.X / BlockSize), FMath::RoundToInt(Location.Y / BlockSize)));
+    }
+}
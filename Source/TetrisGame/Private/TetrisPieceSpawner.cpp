@@ -14,11 +14,32 @@ ATetrisPieceSpawner::ATetrisPieceSpawner()
     Board = nullptr;
 }
 
+void ATetrisPieceSpawner::BeginPlay()
+{
+    Super::BeginPlay();
+
+    Random.Initialize(RandomSeed != 0 ? RandomSeed : FMath::Rand());
+}
+
 void ATetrisPieceSpawner::SetBoardReference(ATetrisBoard* InBoard)
 {
     Board = InBoard;
 }
 
+FTetrisSpawnerState ATetrisPieceSpawner::GetState() const
+{
+    FTetrisSpawnerState State;
+    State.RandomSeed = Random.GetCurrentSeed();
+    State.NextPieceType = NextPieceType;
+    return State;
+}
+
+void ATetrisPieceSpawner::RestoreState(const FTetrisSpawnerState& State)
+{
+    Random.Initialize(State.RandomSeed);
+    NextPieceType = State.NextPieceType;
+}
+
 ATetrisPiece* ATetrisPieceSpawner::SpawnNewPiece()
 {
     if(PieceTypes.Num() == 0) return nullptr;
@@ -51,8 +72,8 @@ TSubclassOf<ATetrisPiece> ATetrisPieceSpawner::GetNextPieceType() const
     return NextPieceType;
 }
 
-TSubclassOf<ATetrisPiece> ATetrisPieceSpawner::GetRandomPieceType() const
+TSubclassOf<ATetrisPiece> ATetrisPieceSpawner::GetRandomPieceType()
 {
     if(PieceTypes.Num() == 0) return nullptr;
-    return PieceTypes[FMath::RandRange(0, PieceTypes.Num() - 1)];
+    return PieceTypes[Random.RandRange(0, PieceTypes.Num() - 1)];
 }
@@ -1,6 +1,7 @@
 #include "TetrisPlayerController.h"
 #include "TetrisPiece.h"
 #include "TetrisBoard.h"
+#include "TetrisTelemetryComponent.h"
 #include "EnhancedInputComponent.h"
 #include "EnhancedInputSubsystems.h"
 #include "InputMappingContext.h"
@@ -10,6 +11,7 @@ ATetrisPlayerController::ATetrisPlayerController()
 {
 	CurrentPiece = nullptr;
 	GameBoard = nullptr;
+	Telemetry = nullptr;
 }
 
 void ATetrisPlayerController::BeginPlay()
@@ -28,6 +30,7 @@ void ATetrisPlayerController::BeginPlay()
 	if (FoundActors.Num() > 0)
 	{
 		GameBoard = Cast<ATetrisBoard>(FoundActors[0]);
+		Telemetry = GameBoard ? GameBoard->FindComponentByClass<UTetrisTelemetryComponent>() : nullptr;
 	}
 }
 
@@ -38,6 +41,11 @@ void ATetrisPlayerController::SetupInputComponent()
 
 void ATetrisPlayerController::MoveLeft()
 {
+	if (Telemetry)
+	{
+		Telemetry->RecordAction(ETetrisInputAction::MoveLeft);
+	}
+
 	if (CurrentPiece && GameBoard)
 	{
 		FVector MovementDirection = -GameBoard->GetActorForwardVector();
@@ -47,6 +55,11 @@ void ATetrisPlayerController::MoveLeft()
 
 void ATetrisPlayerController::MoveRight()
 {
+	if (Telemetry)
+	{
+		Telemetry->RecordAction(ETetrisInputAction::MoveRight);
+	}
+
 	if (CurrentPiece && GameBoard)
 	{
 		FVector MovementDirection = GameBoard->GetActorForwardVector();
@@ -56,6 +69,11 @@ void ATetrisPlayerController::MoveRight()
 
 void ATetrisPlayerController::MoveDown()
 {
+	if (Telemetry)
+	{
+		Telemetry->RecordAction(ETetrisInputAction::SoftDrop);
+	}
+
 	if (CurrentPiece && GameBoard)
 	{
 		FVector MovementDirection = -GameBoard->GetActorUpVector();
@@ -69,14 +87,28 @@ void ATetrisPlayerController::MoveDown()
 
 void ATetrisPlayerController::RotatePiece()
 {
+	if (Telemetry)
+	{
+		Telemetry->RecordAction(ETetrisInputAction::Rotate);
+	}
+
 	if (CurrentPiece)
 	{
 		CurrentPiece->Rotate();
+		if (GameBoard)
+		{
+			GameBoard->MarkBoardDirty();
+		}
 	}
 }
 
 void ATetrisPlayerController::HardDrop()
 {
+	if (Telemetry)
+	{
+		Telemetry->RecordAction(ETetrisInputAction::HardDrop);
+	}
+
 	if (CurrentPiece && GameBoard)
 	{
 		FVector MovementDirection = -GameBoard->GetActorUpVector();
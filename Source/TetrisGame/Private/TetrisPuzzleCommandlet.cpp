@@ -0,0 +1,210 @@
+#include "TetrisPuzzleCommandlet.h"
+#include "TetrisSolver.h"
+#include "HAL/FileManager.h"
+#include "Interfaces/IPluginManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace TetrisPuzzleCommandlet
+{
+    enum class EExpectation : uint8
+    {
+        Solvable,
+        Unsolvable,
+        Count,
+    };
+
+    struct FPuzzle
+    {
+        FTetrisSolverRequest Request;
+        EExpectation Expect = EExpectation::Solvable;
+        int32 ExpectedCount = 0;
+    };
+
+    static bool ParsePuzzle(const TArray<FString>& Lines, FPuzzle& OutPuzzle, FString& OutError)
+    {
+        FTetrisSolverRequest& Request = OutPuzzle.Request;
+        Request.TimeBudgetSeconds = 10.0;
+
+        TArray<FString> BoardRows;
+        int32 Height = 0;
+        for (const FString& RawLine : Lines)
+        {
+            const FString Line = RawLine.TrimStartAndEnd();
+            if (Line.IsEmpty() || Line.StartsWith(TEXT("#")))
+            {
+                continue;
+            }
+
+            FString Key;
+            FString Value;
+            if (!Line.Split(TEXT(":"), &Key, &Value))
+            {
+                BoardRows.Add(Line);
+                continue;
+            }
+            Key = Key.TrimStartAndEnd().ToLower();
+            Value = Value.TrimStartAndEnd();
+
+            TArray<FString> Words;
+            Value.ParseIntoArrayWS(Words);
+            if (Key == TEXT("queue"))
+            {
+                if (!TetrisSolver::ParseQueue(Value, Request.Queue))
+                {
+                    OutError = FString::Printf(TEXT("bad queue '%s'"), *Value);
+                    return false;
+                }
+            }
+            else if (Key == TEXT("goal") && Words.Num() > 0)
+            {
+                Request.Goal = Words[0] == TEXT("lines") ? ETetrisSolverGoal::ClearLines : ETetrisSolverGoal::PerfectClear;
+                Request.LinesToClear = Words.Num() > 1 ? FCString::Atoi(*Words[1]) : 0;
+            }
+            else if (Key == TEXT("budget"))
+            {
+                Request.TimeBudgetSeconds = FCString::Atod(*Value);
+            }
+            else if (Key == TEXT("height"))
+            {
+                Height = FCString::Atoi(*Value);
+            }
+            else if (Key == TEXT("expect") && Words.Num() > 0)
+            {
+                OutPuzzle.Expect = Words[0] == TEXT("unsolvable") ? EExpectation::Unsolvable
+                    : Words[0] == TEXT("count") ? EExpectation::Count : EExpectation::Solvable;
+                OutPuzzle.ExpectedCount = Words.Num() > 1 ? FCString::Atoi(*Words[1]) : 0;
+            }
+            else
+            {
+                OutError = FString::Printf(TEXT("unknown line '%s'"), *Line);
+                return false;
+            }
+        }
+
+        Request.Width = BoardRows.Num() > 0 ? BoardRows[0].Len() : 10;
+        if (Request.Width <= 0 || Request.Width > 64)
+        {
+            OutError = TEXT("board must be 1-64 columns wide");
+            return false;
+        }
+
+        Request.Rows.SetNumZeroed(FMath::Max3(Height, BoardRows.Num(), 20));
+        for (int32 Index = 0; Index < BoardRows.Num(); ++Index)
+        {
+            const FString& Row = BoardRows[Index];
+            if (Row.Len() != Request.Width)
+            {
+                OutError = FString::Printf(TEXT("row '%s' is not %d columns wide"), *Row, Request.Width);
+                return false;
+            }
+
+            uint64& Bits = Request.Rows[BoardRows.Num() - 1 - Index];
+            for (int32 X = 0; X < Row.Len(); ++X)
+            {
+                if (Row[X] != TEXT('.'))
+                {
+                    Bits |= uint64(1) << X;
+                }
+            }
+        }
+
+        if (Request.Queue.Num() == 0)
+        {
+            OutError = TEXT("missing queue");
+            return false;
+        }
+
+        Request.bFindAll = OutPuzzle.Expect == EExpectation::Count;
+        return true;
+    }
+
+    // Empty on a pass, otherwise why it failed
+    static FString CheckResult(const FPuzzle& Puzzle, const FTetrisSolverResult& Result)
+    {
+        const int32 Found = Result.Solutions.Num();
+        switch (Puzzle.Expect)
+        {
+        case EExpectation::Solvable:
+            return Found > 0 ? FString() : Result.bTimedOut ? TEXT("no solution before the time budget ran out") : TEXT("no solution");
+        case EExpectation::Unsolvable:
+            return Found > 0 ? TEXT("found a solution") : Result.bTimedOut ? TEXT("timed out before proving it unsolvable") : FString();
+        case EExpectation::Count:
+            if (Result.bTruncated)
+            {
+                return FString::Printf(TEXT("more than the %d-solution cap"), Found);
+            }
+            if (!Result.IsComplete())
+            {
+                return FString::Printf(TEXT("timed out after %d solution(s)"), Found);
+            }
+            return Found == Puzzle.ExpectedCount ? FString() : FString::Printf(TEXT("found %d solution(s), expected %d"), Found, Puzzle.ExpectedCount);
+        }
+        return FString();
+    }
+}
+
+UTetrisPuzzleCommandlet::UTetrisPuzzleCommandlet()
+{
+    IsClient = false;
+    IsEditor = false;
+    IsServer = false;
+    LogToConsole = true;
+}
+
+int32 UTetrisPuzzleCommandlet::Main(const FString& Params)
+{
+    using namespace TetrisPuzzleCommandlet;
+
+    // Defaults to the known-answer set shipped with the plugin
+    FString PuzzleDir;
+    if (!FParse::Value(*Params, TEXT("Puzzles="), PuzzleDir))
+    {
+        const TSharedPtr<IPlugin> Plugin = IPluginManager::Get().FindPlugin(TEXT("TetrisGame"));
+        if (!Plugin.IsValid())
+        {
+            UE_LOG(LogTemp, Error, TEXT("TetrisPuzzleCommandlet - Usage: -run=TetrisPuzzle [-Puzzles=<dir>] [-Serial]"));
+            return 1;
+        }
+        PuzzleDir = Plugin->GetBaseDir() / TEXT("Resources/Puzzles");
+    }
+    const bool bParallel = !FParse::Param(*Params, TEXT("Serial"));
+
+    TArray<FString> Files;
+    IFileManager::Get().FindFiles(Files, *FPaths::Combine(PuzzleDir, TEXT("*.txt")), true, false);
+    Files.Sort();
+
+    int32 NumFailed = 0;
+    for (const FString& File : Files)
+    {
+        TArray<FString> Lines;
+        FPuzzle Puzzle;
+        FString Error;
+        if (!FFileHelper::LoadFileToStringArray(Lines, *FPaths::Combine(PuzzleDir, File)))
+        {
+            Error = TEXT("could not read file");
+        }
+        else if (ParsePuzzle(Lines, Puzzle, Error))
+        {
+            Puzzle.Request.bParallel = bParallel;
+            const FTetrisSolverResult Result = TetrisSolver::Solve(Puzzle.Request);
+            Error = CheckResult(Puzzle, Result);
+
+            UE_LOG(LogTemp, Display, TEXT("TetrisPuzzleCommandlet - %s: %d solution(s), %lld nodes, %lld memo hits, %lld pruned, %.3fs"),
+                *File, Result.Solutions.Num(), Result.NodesVisited, Result.MemoHits, Result.Pruned, Result.Seconds);
+        }
+
+        if (Error.IsEmpty())
+        {
+            UE_LOG(LogTemp, Display, TEXT("TetrisPuzzleCommandlet - PASS %s"), *File);
+        }
+        else
+        {
+            UE_LOG(LogTemp, Error, TEXT("TetrisPuzzleCommandlet - FAIL %s: %s"), *File, *Error);
+            ++NumFailed;
+        }
+    }
+
+    UE_LOG(LogTemp, Display, TEXT("TetrisPuzzleCommandlet - %d/%d puzzles passed"), Files.Num() - NumFailed, Files.Num());
+    return NumFailed == 0 ? 0 : 1;
+}
@@ -0,0 +1,867 @@
+#include "TetrisReplayArchive.h"
+#include "Algo/BinarySearch.h"
+#include "Async/Async.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/Compression.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace TetrisReplayArchive
+{
+    FString GetSegmentPath(const FString& Directory, uint64 SegmentId)
+    {
+        return FPaths::Combine(Directory, FString::Printf(TEXT("Seg_%08llu.trs"), SegmentId));
+    }
+
+    FString GetIndexPath(const FString& Directory, uint64 SegmentId)
+    {
+        return FPaths::Combine(Directory, FString::Printf(TEXT("Seg_%08llu.tri"), SegmentId));
+    }
+
+    FString GetManifestPath(const FString& Directory)
+    {
+        return FPaths::Combine(Directory, TEXT("Archive.manifest"));
+    }
+
+    FString GetLeasePath(const FString& Directory)
+    {
+        return FPaths::Combine(Directory, TEXT("Archive.lock"));
+    }
+
+    struct FManifestData
+    {
+        uint64 NextSegmentId = 1;
+        // Sealed segments, oldest first
+        TArray<uint64> Segments;
+        // Segments a writer was appending to; recovered on the next Open
+        TArray<uint64> OpenSegments;
+    };
+
+    static void SerializeManifest(FArchive& Ar, FManifestData& Data)
+    {
+        uint32 Magic = ManifestMagic;
+        uint32 Version = FormatVersion;
+        Ar << Magic << Version;
+        if (Ar.IsLoading() && (Magic != ManifestMagic || Version != FormatVersion))
+        {
+            Ar.SetError();
+            return;
+        }
+        Ar << Data.NextSegmentId << Data.Segments << Data.OpenSegments;
+    }
+
+    // False only for a manifest that exists but cannot be read; a missing one is an empty archive
+    static bool ReadManifest(const FString& Directory, FManifestData& OutData)
+    {
+        OutData = FManifestData();
+        TArray<uint8> Bytes;
+        if (!FFileHelper::LoadFileToArray(Bytes, *GetManifestPath(Directory), FILEREAD_Silent))
+        {
+            return !IFileManager::Get().FileExists(*GetManifestPath(Directory));
+        }
+
+        FMemoryReader Ar(Bytes);
+        SerializeManifest(Ar, OutData);
+        return !Ar.IsError();
+    }
+
+    static bool WriteManifest(const FString& Directory, const FManifestData& Data)
+    {
+        TArray<uint8> Bytes;
+        FMemoryWriter Ar(Bytes);
+        FManifestData Copy = Data;
+        SerializeManifest(Ar, Copy);
+
+        // Swap in whole so a reader never sees a partly written manifest
+        const FString Path = GetManifestPath(Directory);
+        const FString TempPath = Path + TEXT(".tmp");
+        if (!FFileHelper::SaveArrayToFile(Bytes, *TempPath) || !IFileManager::Get().Move(*Path, *TempPath, true, true))
+        {
+            UE_LOG(LogTemp, Error, TEXT("TetrisReplayArchive::WriteManifest - Failed to write %s"), *Path);
+            return false;
+        }
+        return true;
+    }
+
+    // Sort by game ID (keeping the last copy of a repeated ID), build the two permutations and write the index
+    static bool WriteIndex(const FString& Directory, uint64 SegmentId, TArray<FIndexEntry>& Entries)
+    {
+        Entries.StableSort([](const FIndexEntry& A, const FIndexEntry& B) { return A.GameId < B.GameId; });
+        int32 Kept = 0;
+        for (int32 Index = 0; Index < Entries.Num(); ++Index)
+        {
+            if (Kept > 0 && Entries[Kept - 1].GameId == Entries[Index].GameId)
+            {
+                Entries[Kept - 1] = Entries[Index];
+            }
+            else
+            {
+                Entries[Kept++] = Entries[Index];
+            }
+        }
+        Entries.SetNum(Kept, EAllowShrinking::No);
+
+        TArray<uint32> ByPlayer;
+        TArray<uint32> ByScore;
+        ByPlayer.SetNumUninitialized(Kept);
+        ByScore.SetNumUninitialized(Kept);
+        for (int32 Index = 0; Index < Kept; ++Index)
+        {
+            ByPlayer[Index] = Index;
+            ByScore[Index] = Index;
+        }
+        ByPlayer.Sort([&Entries](uint32 A, uint32 B)
+        {
+            return Entries[A].PlayerId != Entries[B].PlayerId ? Entries[A].PlayerId < Entries[B].PlayerId : Entries[A].Score > Entries[B].Score;
+        });
+        ByScore.Sort([&Entries](uint32 A, uint32 B)
+        {
+            return Entries[A].Score != Entries[B].Score ? Entries[A].Score > Entries[B].Score : Entries[A].GameId < Entries[B].GameId;
+        });
+
+        FIndexHeader Header;
+        Header.NumEntries = Kept;
+
+        TArray<uint8> Bytes;
+        Bytes.Reserve(sizeof(Header) + Kept * (sizeof(FIndexEntry) + 2 * sizeof(uint32)));
+        Bytes.Append(reinterpret_cast<const uint8*>(&Header), sizeof(Header));
+        Bytes.Append(reinterpret_cast<const uint8*>(Entries.GetData()), Kept * sizeof(FIndexEntry));
+        Bytes.Append(reinterpret_cast<const uint8*>(ByPlayer.GetData()), Kept * sizeof(uint32));
+        Bytes.Append(reinterpret_cast<const uint8*>(ByScore.GetData()), Kept * sizeof(uint32));
+
+        const FString Path = GetIndexPath(Directory, SegmentId);
+        const FString TempPath = Path + TEXT(".tmp");
+        if (!FFileHelper::SaveArrayToFile(Bytes, *TempPath) || !IFileManager::Get().Move(*Path, *TempPath, true, true))
+        {
+            UE_LOG(LogTemp, Error, TEXT("TetrisReplayArchive::WriteIndex - Failed to write %s"), *Path);
+            return false;
+        }
+        return true;
+    }
+
+    // Header of the record at Offset, if it lies entirely within the segment
+    static bool PeekRecord(const uint8* Data, int64 Size, uint64 Offset, FRecordHeader& OutHeader)
+    {
+        if (Offset + sizeof(FRecordHeader) > uint64(Size))
+        {
+            return false;
+        }
+        FMemory::Memcpy(&OutHeader, Data + Offset, sizeof(FRecordHeader));
+        return OutHeader.RecordSize == sizeof(FRecordHeader) - sizeof(uint32) + OutHeader.CompressedSize
+            && Offset + sizeof(uint32) + OutHeader.RecordSize <= uint64(Size);
+    }
+
+    // Entries for every intact record, stopping at the first torn or corrupt one
+    static void ScanSegment(const FString& Path, TArray<FIndexEntry>& OutEntries)
+    {
+        OutEntries.Reset();
+        TUniquePtr<IMappedFileHandle> Handle(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Path));
+        TUniquePtr<IMappedFileRegion> Region(Handle && Handle->GetFileSize() > 0 ? Handle->MapRegion() : nullptr);
+        if (!Region)
+        {
+            return;
+        }
+
+        const uint8* Data = Region->GetMappedPtr();
+        const int64 Size = Region->GetMappedSize();
+        uint64 Offset = sizeof(FSegmentHeader);
+        FRecordHeader Header;
+        while (PeekRecord(Data, Size, Offset, Header)
+            && FCrc::MemCrc32(Data + Offset + sizeof(FRecordHeader), Header.CompressedSize) == Header.PayloadCrc)
+        {
+            OutEntries.Add({ Header.GameId, Header.PlayerId, Header.Score, Offset });
+            Offset += sizeof(uint32) + Header.RecordSize;
+        }
+    }
+
+    // Claim the directory for this process; fails while another live process holds it
+    static bool AcquireWriterLease(const FString& Directory)
+    {
+        const FString Path = GetLeasePath(Directory);
+        const uint32 ProcessId = FPlatformProcess::GetCurrentProcessId();
+        FString Holder;
+        if (FFileHelper::LoadFileToString(Holder, *Path, FFileHelper::EHashOptions::None, FILEREAD_Silent))
+        {
+            const uint32 HolderId = static_cast<uint32>(FCString::Atoi64(*Holder));
+            if (HolderId != 0 && HolderId != ProcessId && FPlatformProcess::IsApplicationRunning(HolderId))
+            {
+                UE_LOG(LogTemp, Error, TEXT("TetrisReplayArchive::Open - %s is held by writer process %u"), *Directory, HolderId);
+                return false;
+            }
+        }
+        return FFileHelper::SaveStringToFile(FString::Printf(TEXT("%u"), ProcessId), *Path);
+    }
+
+    static IFileHandle* CreateSegment(const FString& Directory, uint64 SegmentId)
+    {
+        IFileHandle* File = FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*GetSegmentPath(Directory, SegmentId));
+        FSegmentHeader Header;
+        Header.SegmentId = SegmentId;
+        if (File && !File->Write(reinterpret_cast<const uint8*>(&Header), sizeof(Header)))
+        {
+            delete File;
+            File = nullptr;
+        }
+        return File;
+    }
+}
+
+using namespace TetrisReplayArchive;
+
+FTetrisReplayArchive::~FTetrisReplayArchive()
+{
+    FTSTicker::GetCoreTicker().RemoveTicker(SealTicker);
+    Close();
+}
+
+TSharedPtr<FTetrisReplayArchive, ESPMode::ThreadSafe> FTetrisReplayArchive::GetShared(const FString& Directory)
+{
+    static FCriticalSection SharedLock;
+    static TMap<FString, TWeakPtr<FTetrisReplayArchive, ESPMode::ThreadSafe>> SharedArchives;
+
+    const FString Key = FPaths::ConvertRelativePathToFull(Directory);
+    FScopeLock Lock(&SharedLock);
+    if (TSharedPtr<FTetrisReplayArchive, ESPMode::ThreadSafe> Existing = SharedArchives.FindRef(Key).Pin())
+    {
+        return Existing;
+    }
+
+    TSharedPtr<FTetrisReplayArchive, ESPMode::ThreadSafe> Archive = MakeShared<FTetrisReplayArchive, ESPMode::ThreadSafe>();
+    if (!Archive->Open(Key))
+    {
+        return nullptr;
+    }
+
+    // Sealing writes the index and manifest, so it runs on a worker rather than in the ticker
+    TWeakPtr<FTetrisReplayArchive, ESPMode::ThreadSafe> WeakArchive = Archive;
+    const float CheckInterval = static_cast<float>(FMath::Clamp(Archive->SealSeconds / 4.0, 1.0, 60.0));
+    Archive->SealTicker = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([WeakArchive](float)
+    {
+        TSharedPtr<FTetrisReplayArchive, ESPMode::ThreadSafe> Pinned = WeakArchive.Pin();
+        if (!Pinned)
+        {
+            return false;
+        }
+        AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [Pinned]()
+        {
+            Pinned->SealIfDue();
+        });
+        return true;
+    }), CheckInterval);
+
+    SharedArchives.Add(Key, Archive);
+    return Archive;
+}
+
+bool FTetrisReplayArchive::Open(const FString& InDirectory, int64 InSegmentBytes, double InSealSeconds)
+{
+    Close();
+
+    Directory = InDirectory;
+    SegmentBytes = FMath::Max<int64>(InSegmentBytes, 1);
+    SealSeconds = FMath::Max(InSealSeconds, 1.0);
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    if (!PlatformFile.CreateDirectoryTree(*Directory))
+    {
+        UE_LOG(LogTemp, Error, TEXT("TetrisReplayArchive::Open - Could not create %s"), *Directory);
+        Directory.Reset();
+        return false;
+    }
+
+    // Recovery, segment IDs and the manifest all assume this is the only writer
+    if (!AcquireWriterLease(Directory))
+    {
+        Directory.Reset();
+        return false;
+    }
+    bHoldsWriterLease = true;
+
+    FScopeLock Lock(&ManifestLock);
+    FManifestData Data;
+    if (!ReadManifest(Directory, Data))
+    {
+        UE_LOG(LogTemp, Error, TEXT("TetrisReplayArchive::Open - %s is not a version %d manifest"), *GetManifestPath(Directory), FormatVersion);
+        Close();
+        return false;
+    }
+    Manifest.NextSegmentId = Data.NextSegmentId;
+    Manifest.Segments = Data.Segments;
+    Manifest.OpenSegment = 0;
+
+    // A previous writer died before sealing these; keep every record that made it to disk
+    for (uint64 SegmentId : Data.OpenSegments)
+    {
+        TArray<FIndexEntry> Entries;
+        ScanSegment(GetSegmentPath(Directory, SegmentId), Entries);
+        if (Entries.Num() > 0 && WriteIndex(Directory, SegmentId, Entries))
+        {
+            UE_LOG(LogTemp, Display, TEXT("TetrisReplayArchive::Open - Recovered %d replays from unsealed segment %llu"), Entries.Num(), SegmentId);
+            Manifest.Segments.Add(SegmentId);
+        }
+    }
+    if (!SaveManifest())
+    {
+        Close();
+        return false;
+    }
+
+    // Anything else is left over from an interrupted or blocked compaction
+    TArray<FString> Files;
+    IFileManager::Get().FindFiles(Files, *FPaths::Combine(Directory, TEXT("Seg_*.trs")), true, false);
+    TArray<uint64> Unreferenced;
+    for (const FString& File : Files)
+    {
+        const uint64 SegmentId = FCString::Strtoui64(*File.Mid(4), nullptr, 10);
+        if (!Manifest.Segments.Contains(SegmentId))
+        {
+            Unreferenced.Add(SegmentId);
+        }
+    }
+    DeleteUnreferencedSegments(Unreferenced);
+    return true;
+}
+
+void FTetrisReplayArchive::Close()
+{
+    SealActiveSegment();
+    if (bHoldsWriterLease)
+    {
+        IFileManager::Get().Delete(*GetLeasePath(Directory), false, false, true);
+        bHoldsWriterLease = false;
+    }
+    Directory.Reset();
+}
+
+bool FTetrisReplayArchive::SaveManifest() const
+{
+    FManifestData Data;
+    Data.NextSegmentId = Manifest.NextSegmentId;
+    Data.Segments = Manifest.Segments;
+    if (Manifest.OpenSegment != 0)
+    {
+        Data.OpenSegments.Add(Manifest.OpenSegment);
+    }
+    return WriteManifest(Directory, Data);
+}
+
+bool FTetrisReplayArchive::Append(const FTetrisReplayInfo& Info, const TArray<uint8>& Replay)
+{
+    FScopeLock Lock(&WriterLock);
+    if (Directory.IsEmpty())
+    {
+        return false;
+    }
+
+    if (!ActiveFile)
+    {
+        FScopeLock ManifestScope(&ManifestLock);
+        ActiveSegmentId = Manifest.NextSegmentId++;
+        ActiveFile.Reset(CreateSegment(Directory, ActiveSegmentId));
+        Manifest.OpenSegment = ActiveFile ? ActiveSegmentId : 0;
+        if (!ActiveFile || !SaveManifest())
+        {
+            UE_LOG(LogTemp, Error, TEXT("TetrisReplayArchive::Append - Could not start segment %llu in %s"), ActiveSegmentId, *Directory);
+            ActiveFile.Reset();
+            Manifest.OpenSegment = 0;
+            return false;
+        }
+        ActiveBytes = sizeof(FSegmentHeader);
+        ActiveStartTime = FPlatformTime::Seconds();
+        ActiveEntries.Reset();
+    }
+
+    int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Zlib, Replay.Num());
+    CompressScratch.SetNumUninitialized(sizeof(FRecordHeader) + CompressedSize, EAllowShrinking::No);
+    if (!FCompression::CompressMemory(NAME_Zlib, CompressScratch.GetData() + sizeof(FRecordHeader), CompressedSize, Replay.GetData(), Replay.Num()))
+    {
+        UE_LOG(LogTemp, Error, TEXT("TetrisReplayArchive::Append - Failed to compress game %llu"), Info.GameId);
+        return false;
+    }
+
+    FRecordHeader Header;
+    Header.RecordSize = sizeof(FRecordHeader) - sizeof(uint32) + CompressedSize;
+    Header.PayloadCrc = FCrc::MemCrc32(CompressScratch.GetData() + sizeof(FRecordHeader), CompressedSize);
+    Header.GameId = Info.GameId;
+    Header.PlayerId = Info.PlayerId;
+    Header.Score = Info.Score;
+    Header.EndTime = Info.EndTime;
+    Header.UncompressedSize = Replay.Num();
+    Header.CompressedSize = CompressedSize;
+    FMemory::Memcpy(CompressScratch.GetData(), &Header, sizeof(Header));
+
+    // One write per record, so a crash tears at most the last one
+    const int32 RecordBytes = sizeof(FRecordHeader) + CompressedSize;
+    if (!ActiveFile->Write(CompressScratch.GetData(), RecordBytes))
+    {
+        // The file position is unknown now; seal what was written before and start afresh next time
+        UE_LOG(LogTemp, Error, TEXT("TetrisReplayArchive::Append - Write failed for game %llu"), Info.GameId);
+        SealActiveSegment();
+        return false;
+    }
+    ActiveEntries.Add({ Info.GameId, Info.PlayerId, Info.Score, uint64(ActiveBytes) });
+    ActiveBytes += RecordBytes;
+
+    if (ActiveBytes >= SegmentBytes || FPlatformTime::Seconds() - ActiveStartTime >= SealSeconds)
+    {
+        SealActiveSegment();
+    }
+    return true;
+}
+
+void FTetrisReplayArchive::Flush()
+{
+    FScopeLock Lock(&WriterLock);
+    if (ActiveFile)
+    {
+        ActiveFile->Flush(true);
+    }
+}
+
+bool FTetrisReplayArchive::SealActiveSegment()
+{
+    FScopeLock Lock(&WriterLock);
+    if (!ActiveFile)
+    {
+        return true;
+    }
+
+    ActiveFile->Flush(true);
+    ActiveFile.Reset();
+
+    TArray<FIndexEntry> Entries = MoveTemp(ActiveEntries);
+    ActiveEntries.Reset();
+    return PublishSegment(ActiveSegmentId, Entries);
+}
+
+bool FTetrisReplayArchive::SealIfDue()
+{
+    FScopeLock Lock(&WriterLock);
+    if (!ActiveFile || FPlatformTime::Seconds() - ActiveStartTime < SealSeconds)
+    {
+        return false;
+    }
+    return SealActiveSegment();
+}
+
+bool FTetrisReplayArchive::PublishSegment(uint64 SegmentId, TArray<FIndexEntry>& Entries)
+{
+    if (!WriteIndex(Directory, SegmentId, Entries))
+    {
+        return false;
+    }
+
+    FScopeLock Lock(&ManifestLock);
+    Manifest.Segments.Add(SegmentId);
+    Manifest.OpenSegment = 0;
+    return SaveManifest();
+}
+
+int32 FTetrisReplayArchive::Compact(int64 TargetSegmentBytes)
+{
+    FScopeLock CompactionScope(&CompactionLock);
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+    // Merge the first run of adjacent small segments, so the merged copy of a game never ends
+    // up newer than a copy in a segment outside the run
+    TArray<uint64> Run;
+    uint64 OutputId = 0;
+    {
+        FScopeLock Lock(&ManifestLock);
+        if (Directory.IsEmpty())
+        {
+            return 0;
+        }
+        int64 RunBytes = 0;
+        for (uint64 SegmentId : Manifest.Segments)
+        {
+            const int64 Size = PlatformFile.FileSize(*GetSegmentPath(Directory, SegmentId));
+            const bool bSmall = Size >= 0 && Size < TargetSegmentBytes;
+            if (bSmall && RunBytes + Size <= TargetSegmentBytes)
+            {
+                Run.Add(SegmentId);
+                RunBytes += Size;
+                continue;
+            }
+            if (Run.Num() >= 2)
+            {
+                break;
+            }
+
+            Run.Reset();
+            RunBytes = 0;
+            if (bSmall)
+            {
+                Run.Add(SegmentId);
+                RunBytes = Size;
+            }
+        }
+        if (Run.Num() < 2)
+        {
+            return 0;
+        }
+        OutputId = Manifest.NextSegmentId++;
+        SaveManifest();
+    }
+
+    TUniquePtr<IFileHandle> Output(CreateSegment(Directory, OutputId));
+    if (!Output)
+    {
+        UE_LOG(LogTemp, Error, TEXT("TetrisReplayArchive::Compact - Could not create segment %llu"), OutputId);
+        return 0;
+    }
+
+    // Copy compressed records verbatim, newest segment first so only the latest copy of a game survives
+    TArray<FIndexEntry> Entries;
+    TSet<uint64> SeenGames;
+    int64 OutputBytes = sizeof(FSegmentHeader);
+    for (int32 RunIndex = Run.Num() - 1; RunIndex >= 0; --RunIndex)
+    {
+        TArray<FIndexEntry> InputEntries;
+        TArray<uint8> IndexBytes;
+        if (!FFileHelper::LoadFileToArray(IndexBytes, *GetIndexPath(Directory, Run[RunIndex])))
+        {
+            UE_LOG(LogTemp, Error, TEXT("TetrisReplayArchive::Compact - Missing index for segment %llu"), Run[RunIndex]);
+            PlatformFile.DeleteFile(*GetSegmentPath(Directory, OutputId));
+            return 0;
+        }
+        FIndexHeader IndexHeader;
+        FMemory::Memcpy(&IndexHeader, IndexBytes.GetData(), FMath::Min<int32>(sizeof(IndexHeader), IndexBytes.Num()));
+        const int64 NeededBytes = sizeof(FIndexHeader) + int64(IndexHeader.NumEntries) * sizeof(FIndexEntry);
+        if (IndexHeader.Magic != IndexMagic || IndexHeader.Version != FormatVersion || NeededBytes > IndexBytes.Num())
+        {
+            UE_LOG(LogTemp, Error, TEXT("TetrisReplayArchive::Compact - Bad index for segment %llu"), Run[RunIndex]);
+            PlatformFile.DeleteFile(*GetSegmentPath(Directory, OutputId));
+            return 0;
+        }
+        InputEntries.Append(reinterpret_cast<const FIndexEntry*>(IndexBytes.GetData() + sizeof(FIndexHeader)), IndexHeader.NumEntries);
+
+        TUniquePtr<IMappedFileHandle> Handle(PlatformFile.OpenMapped(*GetSegmentPath(Directory, Run[RunIndex])));
+        TUniquePtr<IMappedFileRegion> Region(Handle ? Handle->MapRegion() : nullptr);
+        if (!Region)
+        {
+            UE_LOG(LogTemp, Error, TEXT("TetrisReplayArchive::Compact - Could not map segment %llu"), Run[RunIndex]);
+            PlatformFile.DeleteFile(*GetSegmentPath(Directory, OutputId));
+            return 0;
+        }
+
+        for (const FIndexEntry& Entry : InputEntries)
+        {
+            bool bAlreadySeen = false;
+            SeenGames.Add(Entry.GameId, &bAlreadySeen);
+            FRecordHeader Header;
+            if (bAlreadySeen || !PeekRecord(Region->GetMappedPtr(), Region->GetMappedSize(), Entry.Offset, Header))
+            {
+                continue;
+            }
+
+            const int64 RecordBytes = sizeof(uint32) + Header.RecordSize;
+            if (!Output->Write(Region->GetMappedPtr() + Entry.Offset, RecordBytes))
+            {
+                UE_LOG(LogTemp, Error, TEXT("TetrisReplayArchive::Compact - Write failed for segment %llu"), OutputId);
+                Output.Reset();
+                PlatformFile.DeleteFile(*GetSegmentPath(Directory, OutputId));
+                return 0;
+            }
+            Entries.Add({ Entry.GameId, Entry.PlayerId, Entry.Score, uint64(OutputBytes) });
+            OutputBytes += RecordBytes;
+        }
+    }
+
+    Output->Flush(true);
+    Output.Reset();
+    if (!WriteIndex(Directory, OutputId, Entries))
+    {
+        PlatformFile.DeleteFile(*GetSegmentPath(Directory, OutputId));
+        return 0;
+    }
+
+    // Sealing only appends to the manifest, so the run is still contiguous
+    {
+        FScopeLock Lock(&ManifestLock);
+        const int32 RunStart = Manifest.Segments.Find(Run[0]);
+        check(RunStart != INDEX_NONE && Manifest.Segments.IsValidIndex(RunStart + Run.Num() - 1));
+        Manifest.Segments.RemoveAt(RunStart, Run.Num(), EAllowShrinking::No);
+        Manifest.Segments.Insert(OutputId, RunStart);
+        SaveManifest();
+    }
+
+    UE_LOG(LogTemp, Display, TEXT("TetrisReplayArchive::Compact - Merged %d segments into %llu (%d replays, %lld bytes)"),
+        Run.Num(), OutputId, Entries.Num(), OutputBytes);
+    DeleteUnreferencedSegments(Run);
+    return Run.Num();
+}
+
+void FTetrisReplayArchive::DeleteUnreferencedSegments(const TArray<uint64>& Candidates)
+{
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    for (uint64 SegmentId : Candidates)
+    {
+        // A reader may still have it mapped; Open retries later
+        const FString SegmentPath = GetSegmentPath(Directory, SegmentId);
+        PlatformFile.DeleteFile(*GetIndexPath(Directory, SegmentId));
+        if (PlatformFile.FileExists(*SegmentPath) && !PlatformFile.DeleteFile(*SegmentPath))
+        {
+            UE_LOG(LogTemp, Verbose, TEXT("TetrisReplayArchive::DeleteUnreferencedSegments - %s is still in use"), *SegmentPath);
+        }
+    }
+}
+
+namespace TetrisReplayArchive
+{
+    // Compaction has to run in the process that owns the archive, so it is a console command
+    // there rather than an offline tool
+    static void RunCompaction(const TArray<FString>& Args)
+    {
+        const FString Directory = Args.Num() > 0 ? Args[0] : FPaths::ProjectSavedDir() / TEXT("Replays");
+        TSharedPtr<FTetrisReplayArchive, ESPMode::ThreadSafe> Archive = FTetrisReplayArchive::GetShared(Directory);
+        if (!Archive)
+        {
+            return;
+        }
+
+        AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [Archive]()
+        {
+            int32 Merged = 0;
+            while (const int32 Count = Archive->Compact())
+            {
+                Merged += Count;
+            }
+            UE_LOG(LogTemp, Display, TEXT("Tetris.CompactReplays - Merged %d segments in %s"), Merged, *Archive->GetDirectory());
+        });
+    }
+
+    static FAutoConsoleCommand CompactReplaysCommand(
+        TEXT("Tetris.CompactReplays"),
+        TEXT("Merge small sealed replay segments in the background while recording continues. Optional arg: archive directory (default Saved/Replays)."),
+        FConsoleCommandWithArgsDelegate::CreateStatic(&RunCompaction));
+}
+
+FTetrisReplayArchiveReader::FTetrisReplayArchiveReader() = default;
+
+FTetrisReplayArchiveReader::~FTetrisReplayArchiveReader() = default;
+
+TUniquePtr<FTetrisReplayArchiveReader::FMappedSegment> FTetrisReplayArchiveReader::MapSegment(const FString& Directory, uint64 SegmentId)
+{
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    TUniquePtr<FMappedSegment> Segment = MakeUnique<FMappedSegment>();
+    Segment->SegmentId = SegmentId;
+    Segment->SegmentHandle.Reset(PlatformFile.OpenMapped(*GetSegmentPath(Directory, SegmentId)));
+    Segment->IndexHandle.Reset(PlatformFile.OpenMapped(*GetIndexPath(Directory, SegmentId)));
+    if (Segment->SegmentHandle)
+    {
+        Segment->SegmentRegion.Reset(Segment->SegmentHandle->MapRegion());
+    }
+    if (Segment->IndexHandle)
+    {
+        Segment->IndexRegion.Reset(Segment->IndexHandle->MapRegion());
+    }
+    if (!Segment->SegmentRegion || !Segment->IndexRegion || Segment->IndexRegion->GetMappedSize() < int64(sizeof(FIndexHeader)))
+    {
+        return nullptr;
+    }
+
+    const uint8* IndexData = Segment->IndexRegion->GetMappedPtr();
+    FIndexHeader Header;
+    FMemory::Memcpy(&Header, IndexData, sizeof(Header));
+    const int64 NeededBytes = sizeof(FIndexHeader) + int64(Header.NumEntries) * (sizeof(FIndexEntry) + 2 * sizeof(uint32));
+    if (Header.Magic != IndexMagic || Header.Version != FormatVersion || NeededBytes > Segment->IndexRegion->GetMappedSize())
+    {
+        return nullptr;
+    }
+
+    // Mappings are page aligned and the header keeps the tables 8-byte aligned
+    Segment->NumEntries = Header.NumEntries;
+    Segment->Entries = reinterpret_cast<const FIndexEntry*>(IndexData + sizeof(FIndexHeader));
+    Segment->ByPlayer = reinterpret_cast<const uint32*>(Segment->Entries + Header.NumEntries);
+    Segment->ByScore = Segment->ByPlayer + Header.NumEntries;
+    return Segment;
+}
+
+bool FTetrisReplayArchiveReader::Open(const FString& Directory)
+{
+    // A compaction only deletes its inputs after publishing the manifest that replaces them,
+    // so a segment that vanished means there is a newer manifest to read
+    constexpr int32 MaxAttempts = 4;
+    for (int32 Attempt = 1;; ++Attempt)
+    {
+        Close();
+
+        FManifestData Data;
+        if (!ReadManifest(Directory, Data))
+        {
+            UE_LOG(LogTemp, Error, TEXT("TetrisReplayArchiveReader::Open - %s is not a version %d manifest"), *GetManifestPath(Directory), FormatVersion);
+            return false;
+        }
+
+        TArray<uint64> Unmapped;
+        for (int32 Index = Data.Segments.Num() - 1; Index >= 0; --Index)
+        {
+            if (TUniquePtr<FMappedSegment> Segment = MapSegment(Directory, Data.Segments[Index]))
+            {
+                Segments.Add(MoveTemp(Segment));
+            }
+            else
+            {
+                Unmapped.Add(Data.Segments[Index]);
+            }
+        }
+        if (Unmapped.Num() == 0)
+        {
+            return true;
+        }
+
+        // Same manifest means the files are really missing or damaged, not replaced
+        FManifestData Latest;
+        if (Attempt == MaxAttempts || !ReadManifest(Directory, Latest) || Latest.Segments == Data.Segments)
+        {
+            for (uint64 SegmentId : Unmapped)
+            {
+                UE_LOG(LogTemp, Warning, TEXT("TetrisReplayArchiveReader::Open - Skipping segment %llu, could not map it or its index"), SegmentId);
+            }
+            return true;
+        }
+        UE_LOG(LogTemp, Verbose, TEXT("TetrisReplayArchiveReader::Open - Manifest changed while opening %s, retrying"), *Directory);
+    }
+}
+
+void FTetrisReplayArchiveReader::Close()
+{
+    Segments.Reset();
+}
+
+int64 FTetrisReplayArchiveReader::GetNumGames() const
+{
+    int64 Total = 0;
+    for (const TUniquePtr<FMappedSegment>& Segment : Segments)
+    {
+        Total += Segment->NumEntries;
+    }
+    return Total;
+}
+
+bool FTetrisReplayArchiveReader::ReadRecord(const FMappedSegment& Segment, uint64 Offset, FTetrisReplayInfo& OutInfo, TArray<uint8>* OutReplay) const
+{
+    const uint8* Data = Segment.SegmentRegion->GetMappedPtr();
+    FRecordHeader Header;
+    if (!PeekRecord(Data, Segment.SegmentRegion->GetMappedSize(), Offset, Header))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("TetrisReplayArchiveReader::ReadRecord - Bad record at %llu in segment %llu"), Offset, Segment.SegmentId);
+        return false;
+    }
+
+    OutInfo.GameId = Header.GameId;
+    OutInfo.PlayerId = Header.PlayerId;
+    OutInfo.Score = Header.Score;
+    OutInfo.EndTime = Header.EndTime;
+    if (!OutReplay)
+    {
+        return true;
+    }
+
+    const uint8* Payload = Data + Offset + sizeof(FRecordHeader);
+    OutReplay->SetNumUninitialized(Header.UncompressedSize);
+    if (FCrc::MemCrc32(Payload, Header.CompressedSize) != Header.PayloadCrc
+        || !FCompression::UncompressMemory(NAME_Zlib, OutReplay->GetData(), Header.UncompressedSize, Payload, Header.CompressedSize))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("TetrisReplayArchiveReader::ReadRecord - Corrupt replay for game %llu in segment %llu"), Header.GameId, Segment.SegmentId);
+        OutReplay->Reset();
+        return false;
+    }
+    return true;
+}
+
+bool FTetrisReplayArchiveReader::FindGame(uint64 GameId, FTetrisReplayInfo& OutInfo, TArray<uint8>* OutReplay) const
+{
+    for (const TUniquePtr<FMappedSegment>& Segment : Segments)
+    {
+        const TArrayView<const FIndexEntry> Entries(Segment->Entries, Segment->NumEntries);
+        const int32 Index = Algo::LowerBoundBy(Entries, GameId, &FIndexEntry::GameId);
+        if (Index < Entries.Num() && Entries[Index].GameId == GameId)
+        {
+            return ReadRecord(*Segment, Entries[Index].Offset, OutInfo, OutReplay);
+        }
+    }
+    return false;
+}
+
+bool FTetrisReplayArchiveReader::IsNewestCopy(int32 SegmentIndex, uint64 GameId) const
+{
+    for (int32 Newer = 0; Newer < SegmentIndex; ++Newer)
+    {
+        const TArrayView<const FIndexEntry> Entries(Segments[Newer]->Entries, Segments[Newer]->NumEntries);
+        const int32 Index = Algo::LowerBoundBy(Entries, GameId, &FIndexEntry::GameId);
+        if (Index < Entries.Num() && Entries[Index].GameId == GameId)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void FTetrisReplayArchiveReader::MergeByScore(TArray<FScoreCursor>& Cursors, int32 Count, TArray<FTetrisReplayInfo>& OutGames) const
+{
+    // Take the best remaining entry across segments until Count current copies are found. Ties
+    // go to the newer segment; there are few segments, so a linear pick is cheaper than a heap.
+    OutGames.Reset();
+    while (OutGames.Num() < Count)
+    {
+        FScoreCursor* Best = nullptr;
+        for (FScoreCursor& Cursor : Cursors)
+        {
+            if (Cursor.Next < Cursor.End && (!Best || Cursor.Entry()->Score > Best->Entry()->Score))
+            {
+                Best = &Cursor;
+            }
+        }
+        if (!Best)
+        {
+            break;
+        }
+
+        const FIndexEntry* Entry = Best->Entry();
+        ++Best->Next;
+
+        // Older copies of a re-archived game are superseded, whatever their score
+        FTetrisReplayInfo Info;
+        if (IsNewestCopy(Best->SegmentIndex, Entry->GameId) && ReadRecord(*Segments[Best->SegmentIndex], Entry->Offset, Info, nullptr))
+        {
+            OutGames.Add(Info);
+        }
+    }
+}
+
+void FTetrisReplayArchiveReader::GetTopScores(int32 Count, TArray<FTetrisReplayInfo>& OutGames) const
+{
+    TArray<FScoreCursor> Cursors;
+    for (int32 Index = 0; Index < Segments.Num(); ++Index)
+    {
+        const FMappedSegment& Segment = *Segments[Index];
+        Cursors.Add({ Index, Segment.Entries, Segment.ByScore, 0, int32(Segment.NumEntries) });
+    }
+    MergeByScore(Cursors, Count, OutGames);
+}
+
+void FTetrisReplayArchiveReader::GetPlayerGames(uint64 PlayerId, int32 MaxGames, TArray<FTetrisReplayInfo>& OutGames) const
+{
+    // Each segment's games by this player are one run of its player table, best first
+    TArray<FScoreCursor> Cursors;
+    for (int32 Index = 0; Index < Segments.Num(); ++Index)
+    {
+        const FMappedSegment& Segment = *Segments[Index];
+        const TArrayView<const uint32> ByPlayer(Segment.ByPlayer, Segment.NumEntries);
+        const FIndexEntry* Entries = Segment.Entries;
+        const int32 First = Algo::LowerBoundBy(ByPlayer, PlayerId, [Entries](uint32 Entry) { return Entries[Entry].PlayerId; });
+        const int32 End = Algo::UpperBoundBy(ByPlayer, PlayerId, [Entries](uint32 Entry) { return Entries[Entry].PlayerId; });
+        if (First < End)
+        {
+            Cursors.Add({ Index, Entries, Segment.ByPlayer, First, End });
+        }
+    }
+    MergeByScore(Cursors, MaxGames, OutGames);
+}
@@ -0,0 +1,116 @@
+#include "TetrisReplayQueryCommandlet.h"
+#include "TetrisReplayArchive.h"
+#include "Misc/FileHelper.h"
+
+namespace TetrisReplayQueryCommandlet
+{
+    static void LogGames(const TCHAR* Title, const TArray<FTetrisReplayInfo>& Games)
+    {
+        UE_LOG(LogTemp, Display, TEXT("TetrisReplayQueryCommandlet - %s (%d)"), Title, Games.Num());
+        for (int32 Rank = 0; Rank < Games.Num(); ++Rank)
+        {
+            const FTetrisReplayInfo& Game = Games[Rank];
+            UE_LOG(LogTemp, Display, TEXT("  %4d. game %llu  player %llu  score %lld  ended %s"),
+                Rank + 1, Game.GameId, Game.PlayerId, Game.Score, *FDateTime::FromUnixTimestamp(Game.EndTime).ToString());
+        }
+    }
+
+    static bool ParseId(const FString& Params, const TCHAR* Key, uint64& OutId)
+    {
+        FString Text;
+        if (!FParse::Value(*Params, Key, Text))
+        {
+            return false;
+        }
+        OutId = FCString::Strtoui64(*Text, nullptr, 10);
+        return true;
+    }
+}
+
+UTetrisReplayQueryCommandlet::UTetrisReplayQueryCommandlet()
+{
+    IsClient = false;
+    IsEditor = false;
+    IsServer = false;
+    LogToConsole = true;
+}
+
+int32 UTetrisReplayQueryCommandlet::Main(const FString& Params)
+{
+    using namespace TetrisReplayQueryCommandlet;
+
+    FString Directory;
+    if (!FParse::Value(*Params, TEXT("Archive="), Directory))
+    {
+        UE_LOG(LogTemp, Error, TEXT("TetrisReplayQueryCommandlet - Usage: -run=TetrisReplayQuery -Archive=<dir> [-Top=N] [-Player=<id>] [-Game=<id> [-Export=<file>]] [-Compact]"));
+        return 1;
+    }
+
+    if (FParse::Param(*Params, TEXT("Compact")))
+    {
+        // Open refuses while a server holds the directory; compacting under it would fork the manifest
+        FTetrisReplayArchive Archive;
+        if (!Archive.Open(Directory))
+        {
+            UE_LOG(LogTemp, Error, TEXT("TetrisReplayQueryCommandlet - Not compacting; use Tetris.CompactReplays in the process writing %s"), *Directory);
+            return 1;
+        }
+        int32 Merged = 0;
+        while (const int32 Count = Archive.Compact())
+        {
+            Merged += Count;
+        }
+        UE_LOG(LogTemp, Display, TEXT("TetrisReplayQueryCommandlet - Compaction merged %d segments"), Merged);
+        Archive.Close();
+    }
+
+    FTetrisReplayArchiveReader Reader;
+    if (!Reader.Open(Directory))
+    {
+        return 1;
+    }
+    UE_LOG(LogTemp, Display, TEXT("TetrisReplayQueryCommandlet - %lld games in %s"), Reader.GetNumGames(), *Directory);
+
+    int32 Result = 0;
+    TArray<FTetrisReplayInfo> Games;
+    int32 Top = 0;
+    if (FParse::Value(*Params, TEXT("Top="), Top) && Top > 0)
+    {
+        Reader.GetTopScores(Top, Games);
+        LogGames(TEXT("Top scores"), Games);
+    }
+
+    uint64 PlayerId = 0;
+    if (ParseId(Params, TEXT("Player="), PlayerId))
+    {
+        int32 MaxGames = 20;
+        FParse::Value(*Params, TEXT("Max="), MaxGames);
+        Reader.GetPlayerGames(PlayerId, MaxGames, Games);
+        LogGames(*FString::Printf(TEXT("Best games of player %llu"), PlayerId), Games);
+    }
+
+    uint64 GameId = 0;
+    if (ParseId(Params, TEXT("Game="), GameId))
+    {
+        FString ExportPath;
+        const bool bExport = FParse::Value(*Params, TEXT("Export="), ExportPath);
+
+        FTetrisReplayInfo Info;
+        TArray<uint8> Replay;
+        if (!Reader.FindGame(GameId, Info, bExport ? &Replay : nullptr))
+        {
+            UE_LOG(LogTemp, Error, TEXT("TetrisReplayQueryCommandlet - Game %llu not found"), GameId);
+            Result = 1;
+        }
+        else
+        {
+            LogGames(TEXT("Game"), { Info });
+            if (bExport && !FFileHelper::SaveArrayToFile(Replay, *ExportPath))
+            {
+                UE_LOG(LogTemp, Error, TEXT("TetrisReplayQueryCommandlet - Could not write %s"), *ExportPath);
+                Result = 1;
+            }
+        }
+    }
+    return Result;
+}
@@ -0,0 +1,103 @@
+#include "TetrisReplayRecorder.h"
+#include "TetrisBoard.h"
+#include "TetrisReplayArchive.h"
+#include "TetrisSpectatorPublisher.h"
+#include "Async/Async.h"
+#include "Misc/Paths.h"
+#include "TimerManager.h"
+
+UTetrisReplayRecorder::UTetrisReplayRecorder()
+{
+    PrimaryComponentTick.bCanEverTick = true;
+}
+
+void UTetrisReplayRecorder::BeginPlay()
+{
+    Super::BeginPlay();
+    SetComponentTickInterval(PollInterval);
+
+    Board = Cast<ATetrisBoard>(GetOwner());
+    Publisher = GetOwner()->FindComponentByClass<UTetrisSpectatorPublisher>();
+    if (!Board || !Publisher)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("TetrisReplayRecorder::BeginPlay - Needs a board with a spectator publisher, not recording"));
+        SetComponentTickEnabled(false);
+        return;
+    }
+
+    const FString Directory = ArchiveDirectory.IsEmpty() ? FPaths::ProjectSavedDir() / TEXT("Replays") : ArchiveDirectory;
+    Archive = FTetrisReplayArchive::GetShared(Directory);
+    Board->OnGameOver.AddDynamic(this, &UTetrisReplayRecorder::HandleGameOver);
+    StartGame();
+}
+
+void UTetrisReplayRecorder::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (Board)
+    {
+        Board->OnGameOver.RemoveAll(this);
+    }
+    if (UWorld* World = GetWorld())
+    {
+        World->GetTimerManager().ClearAllTimersForObject(this);
+    }
+
+    // An unfinished game is not archived
+    Recording.Reset();
+    Archive.Reset();
+    Super::EndPlay(EndPlayReason);
+}
+
+void UTetrisReplayRecorder::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+    Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+    Poll();
+}
+
+void UTetrisReplayRecorder::Poll()
+{
+    // The publisher replaces its stream in BeginPlay, so look it up each time
+    if (Publisher)
+    {
+        Cursor.Poll(Publisher->GetStream().Get(), Recording);
+    }
+}
+
+void UTetrisReplayRecorder::HandleGameOver()
+{
+    // The publisher may not have appended its GameOver frame yet
+    GetWorld()->GetTimerManager().SetTimerForNextTick(this, &UTetrisReplayRecorder::FinishGame);
+}
+
+void UTetrisReplayRecorder::FinishGame()
+{
+    Poll();
+
+    if (Archive && Recording.Num() > 0)
+    {
+        FTetrisReplayInfo Info;
+        Info.GameId = GameId;
+        Info.PlayerId = static_cast<uint64>(PlayerId);
+        Info.Score = Board ? Board->CurrentScore : 0;
+        Info.EndTime = FDateTime::UtcNow().ToUnixTimestamp();
+
+        // Compressing and writing happen on a worker; the archive serializes appends itself
+        AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [Archive = Archive, Info, Replay = MoveTemp(Recording)]()
+        {
+            Archive->Append(Info, Replay);
+        });
+    }
+
+    StartGame();
+}
+
+void UTetrisReplayRecorder::StartGame()
+{
+    const FGuid Guid = FGuid::NewGuid();
+    GameId = (uint64(Guid.A) << 32 | Guid.B) ^ (uint64(Guid.C) << 32 | Guid.D);
+
+    // Rejoin from a snapshot so each recording stands on its own
+    Recording.Reset();
+    Cursor.NextSequence = INDEX_NONE;
+    Poll();
+}
@@ -0,0 +1,248 @@
+#include "TetrisSimulation.h"
+#include "Math/RandomStream.h"
+
+int32 FTetrisSimShape::AddRotation(const FIntPoint* Cells, int32 NumCells)
+{
+    if (NumCells <= 0)
+    {
+        return INDEX_NONE;
+    }
+
+    FIntPoint Min = Cells[0];
+    FIntPoint Max = Cells[0];
+    for (int32 Index = 1; Index < NumCells; ++Index)
+    {
+        Min = Min.ComponentMin(Cells[Index]);
+        Max = Max.ComponentMax(Cells[Index]);
+    }
+
+    FTetrisSimRotation Rotation;
+    Rotation.Width = Max.X - Min.X + 1;
+    Rotation.Height = Max.Y - Min.Y + 1;
+    if (Rotation.Width > FTetrisSimRotation::MaxExtent || Rotation.Height > FTetrisSimRotation::MaxExtent)
+    {
+        return INDEX_NONE;
+    }
+
+    for (int32 Column = 0; Column < FTetrisSimRotation::MaxExtent; ++Column)
+    {
+        Rotation.ColumnBottom[Column] = FTetrisSimRotation::MaxExtent;
+    }
+    for (int32 Index = 0; Index < NumCells; ++Index)
+    {
+        const int32 X = Cells[Index].X - Min.X;
+        const int32 Y = Cells[Index].Y - Min.Y;
+        Rotation.RowBits[Y] |= uint64(1) << X;
+        Rotation.ColumnBottom[X] = FMath::Min(Rotation.ColumnBottom[X], Y);
+    }
+
+    for (int32 Existing = 0; Existing < Rotations.Num(); ++Existing)
+    {
+        const FTetrisSimRotation& Other = Rotations[Existing];
+        if (Other.Width == Rotation.Width && Other.Height == Rotation.Height
+            && FMemory::Memcmp(Other.RowBits, Rotation.RowBits, sizeof(Rotation.RowBits)) == 0)
+        {
+            return Existing;
+        }
+    }
+    return Rotations.Add(Rotation);
+}
+
+void FTetrisSimBoard::Init(int32 InWidth, int32 InHeight)
+{
+    check(InWidth > 0 && InWidth <= 64 && InHeight > 0);
+
+    Width = InWidth;
+    Height = InHeight;
+    RowMask = Width == 64 ? ~uint64(0) : (uint64(1) << Width) - 1;
+    Rows.SetNumZeroed(Height);
+    ColumnHeights.SetNumZeroed(Width);
+}
+
+void FTetrisSimBoard::SetRows(const uint64* InRows)
+{
+    for (int32 Y = 0; Y < Height; ++Y)
+    {
+        Rows[Y] = InRows[Y] & RowMask;
+    }
+    UpdateColumnHeights();
+}
+
+int32 FTetrisSimBoard::FindLandingRow(const FTetrisSimRotation& Rotation, int32 X) const
+{
+    if (X < 0 || X + Rotation.Width > Width)
+    {
+        return INDEX_NONE;
+    }
+
+    // Dropping from above, the piece stops on whichever column it reaches first
+    int32 Y = 0;
+    for (int32 Column = 0; Column < Rotation.Width; ++Column)
+    {
+        Y = FMath::Max(Y, ColumnHeights[X + Column] - Rotation.ColumnBottom[Column]);
+    }
+    return Y + Rotation.Height <= Height ? Y : INDEX_NONE;
+}
+
+void FTetrisSimBoard::Stamp(uint64* InRows, const FTetrisSimRotation& Rotation, int32 X, int32 Y)
+{
+    for (int32 Row = 0; Row < Rotation.Height; ++Row)
+    {
+        InRows[Y + Row] |= Rotation.RowBits[Row] << X;
+    }
+}
+
+int32 FTetrisSimBoard::Place(const FTetrisSimRotation& Rotation, int32 X, int32 Y)
+{
+    Stamp(Rows.GetData(), Rotation, X, Y);
+
+    // Only the rows the piece touched can have become full
+    int32 Write = Y;
+    for (int32 Read = Y; Read < Height; ++Read)
+    {
+        if (Read >= Y + Rotation.Height || Rows[Read] != RowMask)
+        {
+            Rows[Write++] = Rows[Read];
+        }
+    }
+
+    const int32 Cleared = Height - Write;
+    for (; Write < Height; ++Write)
+    {
+        Rows[Write] = 0;
+    }
+
+    UpdateColumnHeights();
+    return Cleared;
+}
+
+void FTetrisSimBoard::UpdateColumnHeights()
+{
+    uint64 Seen = 0;
+    for (int32 Y = Height - 1; Y >= 0 && Seen != RowMask; --Y)
+    {
+        uint64 NewColumns = Rows[Y] & ~Seen;
+        Seen |= NewColumns;
+        while (NewColumns)
+        {
+            ColumnHeights[FMath::CountTrailingZeros64(NewColumns)] = Y + 1;
+            NewColumns &= NewColumns - 1;
+        }
+    }
+
+    uint64 Empty = ~Seen & RowMask;
+    while (Empty)
+    {
+        ColumnHeights[FMath::CountTrailingZeros64(Empty)] = 0;
+        Empty &= Empty - 1;
+    }
+}
+
+namespace TetrisSimulation
+{
+    static FTetrisSimShape MakeShape(std::initializer_list<FIntPoint> Cells)
+    {
+        FTetrisSimShape Shape;
+        TArray<FIntPoint, TInlineAllocator<4>> Rotated(Cells.begin(), static_cast<int32>(Cells.size()));
+        for (int32 Turn = 0; Turn < 4; ++Turn)
+        {
+            Shape.AddRotation(Rotated.GetData(), Rotated.Num());
+            for (FIntPoint& Cell : Rotated)
+            {
+                Cell = FIntPoint(Cell.Y, -Cell.X);
+            }
+        }
+        return Shape;
+    }
+
+    const TArray<FTetrisSimShape>& GetStandardShapes()
+    {
+        static const TArray<FTetrisSimShape> Shapes = {
+            MakeShape({ FIntPoint(0, 0), FIntPoint(1, 0), FIntPoint(2, 0), FIntPoint(3, 0) }),
+            MakeShape({ FIntPoint(0, 0), FIntPoint(1, 0), FIntPoint(0, 1), FIntPoint(1, 1) }),
+            MakeShape({ FIntPoint(0, 0), FIntPoint(1, 0), FIntPoint(2, 0), FIntPoint(1, 1) }),
+            MakeShape({ FIntPoint(0, 0), FIntPoint(1, 0), FIntPoint(1, 1), FIntPoint(2, 1) }),
+            MakeShape({ FIntPoint(1, 0), FIntPoint(2, 0), FIntPoint(0, 1), FIntPoint(1, 1) }),
+            MakeShape({ FIntPoint(0, 0), FIntPoint(1, 0), FIntPoint(2, 0), FIntPoint(0, 1) }),
+            MakeShape({ FIntPoint(0, 0), FIntPoint(1, 0), FIntPoint(2, 0), FIntPoint(2, 1) }),
+        };
+        return Shapes;
+    }
+
+    FTetrisSimPlacement FindBestPlacement(const FTetrisSimBoard& Board, const FTetrisSimShape& Shape,
+        const FTetrisPlacementWeights& Weights, FTetrisSimScratch& Scratch)
+    {
+        const int32 Height = Board.GetHeight();
+        Scratch.Placements.Reset();
+        Scratch.CandidateRows.Reset();
+
+        // Lay every candidate board out back to back so the evaluator can batch them
+        for (int32 RotationIndex = 0; RotationIndex < Shape.Rotations.Num(); ++RotationIndex)
+        {
+            const FTetrisSimRotation& Rotation = Shape.Rotations[RotationIndex];
+            for (int32 X = 0; X + Rotation.Width <= Board.GetWidth(); ++X)
+            {
+                const int32 Y = Board.FindLandingRow(Rotation, X);
+                if (Y == INDEX_NONE)
+                {
+                    continue;
+                }
+
+                FTetrisSimPlacement& Placement = Scratch.Placements.AddDefaulted_GetRef();
+                Placement.Rotation = RotationIndex;
+                Placement.X = X;
+                Placement.Y = Y;
+
+                const int32 Offset = Scratch.CandidateRows.AddUninitialized(Height);
+                FMemory::Memcpy(Scratch.CandidateRows.GetData() + Offset, Board.GetRows(), Height * sizeof(uint64));
+                FTetrisSimBoard::Stamp(Scratch.CandidateRows.GetData() + Offset, Rotation, X, Y);
+            }
+        }
+
+        const int32 Best = TetrisBoardEval::PickBestPlacement(Scratch.CandidateRows.GetData(), Scratch.Placements.Num(),
+            Board.GetWidth(), Height, Weights, Scratch.Features);
+        return Best != INDEX_NONE ? Scratch.Placements[Best] : FTetrisSimPlacement();
+    }
+
+    FTetrisSimGameResult PlayGame(const FTetrisPlacementWeights& Weights, int32 Seed, const FTetrisSimConfig& Config)
+    {
+        const TArray<FTetrisSimShape>& Shapes = GetStandardShapes();
+
+        FTetrisSimBoard Board;
+        Board.Init(Config.Width, Config.Height);
+
+        FTetrisSimScratch Scratch;
+        FRandomStream Random(Seed);
+        TArray<int32, TInlineAllocator<7>> Bag;
+
+        FTetrisSimGameResult Result;
+        while (Result.Pieces < Config.MaxPieces)
+        {
+            if (Bag.Num() == 0)
+            {
+                for (int32 Index = 0; Index < Shapes.Num(); ++Index)
+                {
+                    Bag.Add(Index);
+                }
+                for (int32 Index = Bag.Num() - 1; Index > 0; --Index)
+                {
+                    Bag.Swap(Index, Random.RandRange(0, Index));
+                }
+            }
+
+            const FTetrisSimShape& Shape = Shapes[Bag.Pop(EAllowShrinking::No)];
+            const FTetrisSimPlacement Placement = FindBestPlacement(Board, Shape, Weights, Scratch);
+            if (!Placement.IsValid())
+            {
+                Result.bToppedOut = true;
+                break;
+            }
+
+            const int32 Cleared = Board.Place(Shape.Rotations[Placement.Rotation], Placement.X, Placement.Y);
+            Result.Lines += Cleared;
+            Result.Score += Cleared * Cleared * 100;
+            ++Result.Pieces;
+        }
+        return Result;
+    }
+}
@@ -0,0 +1,179 @@
+#include "TetrisSnapshotRing.h"
+
+void FTetrisSnapshotRing::SetCapacity(int32 InCapacity)
+{
+    Entries.Reset();
+    Entries.SetNum(FMath::Max(InCapacity, 0));
+    Current = FTetrisBoardSnapshot();
+    Head = 0;
+    Num = 0;
+    Cursor = INDEX_NONE;
+}
+
+void FTetrisSnapshotRing::Reset()
+{
+    SetCapacity(Entries.Num());
+}
+
+void FTetrisSnapshotRing::Truncate(int32 Index)
+{
+    // Overwrite rather than leave stale entries, so their rows and chunks are released now
+    for (int32 Dropped = Index; Dropped < Num; ++Dropped)
+    {
+        Get(Dropped) = FEntry();
+    }
+    Num = FMath::Min(Num, Index);
+}
+
+void FTetrisSnapshotRing::ApplyDelta(const TArray<uint64>& Delta, FTetrisBoardGrid& Grid)
+{
+    const int32 WordsPerRow = Grid.GetWordsPerRow();
+    for (int32 Offset = 0; Offset < Delta.Num();)
+    {
+        const int32 StartRow = static_cast<int32>(Delta[Offset] >> 32);
+        const int32 NumRows = static_cast<int32>(Delta[Offset] & 0xFFFFFFFF);
+        ++Offset;
+        for (int32 Row = 0; Row < NumRows; ++Row, Offset += WordsPerRow)
+        {
+            FMemory::Memcpy(Grid.GetMutableRow(StartRow + Row), Delta.GetData() + Offset, WordsPerRow * sizeof(uint64));
+        }
+    }
+}
+
+void FTetrisSnapshotRing::Push(FTetrisBoardSnapshot&& Snapshot)
+{
+    if (Entries.Num() == 0)
+    {
+        return;
+    }
+
+    // Current holds the cursor entry, which is the newest once the redo entries are gone
+    Truncate(Cursor + 1);
+
+    TArray<int32> ChangedRows;
+    int32 SinceKeyframe = 0;
+    const bool bResized = Snapshot.Grid.GetWidth() != Current.Grid.GetWidth() || Snapshot.Grid.GetHeight() != Current.Grid.GetHeight();
+    if (Num > 0 && !bResized)
+    {
+        Snapshot.Grid.GetChangedRows(Current.Grid, ChangedRows);
+        while (!Get(Num - 1 - SinceKeyframe).Keyframe)
+        {
+            ++SinceKeyframe;
+        }
+    }
+
+    if (Num == Entries.Num())
+    {
+        // The oldest entry is always a keyframe; roll it forward onto its successor
+        FEntry& Evicted = Get(0);
+        FEntry& Next = Get(1 % Num);
+        if (Num > 1 && !Next.Keyframe)
+        {
+            ApplyDelta(Next.Delta, *Evicted.Keyframe);
+            Next.Keyframe = MoveTemp(Evicted.Keyframe);
+            Next.Delta.Empty();
+        }
+        Evicted = FEntry();
+        Head = (Head + 1) % Entries.Num();
+        --Num;
+        SinceKeyframe = FMath::Min(SinceKeyframe, Num - 1);
+    }
+
+    FEntry& Entry = Get(Num);
+    Entry.SpawnerState = Snapshot.SpawnerState;
+    Entry.Score = Snapshot.Score;
+    Entry.PieceNumber = Snapshot.PieceNumber;
+    if (Num == 0 || bResized || SinceKeyframe + 1 >= KeyframeInterval || ChangedRows.Num() > FTetrisBoardGrid::ChunkRows)
+    {
+        Entry.Keyframe = MakeUnique<FTetrisBoardGrid>(Snapshot.Grid);
+    }
+    else
+    {
+        const int32 WordsPerRow = Snapshot.Grid.GetWordsPerRow();
+        Entry.Delta.Reserve(ChangedRows.Num() * (WordsPerRow + 1));
+        for (int32 Index = 0; Index < ChangedRows.Num();)
+        {
+            // Consecutive rows share one run header
+            int32 End = Index + 1;
+            while (End < ChangedRows.Num() && ChangedRows[End] == ChangedRows[End - 1] + 1)
+            {
+                ++End;
+            }
+            Entry.Delta.Add(uint64(ChangedRows[Index]) << 32 | uint64(End - Index));
+            for (; Index < End; ++Index)
+            {
+                Entry.Delta.Append(Snapshot.Grid.GetRow(ChangedRows[Index]), WordsPerRow);
+            }
+        }
+    }
+
+    Current = MoveTemp(Snapshot);
+    Cursor = Num++;
+}
+
+const FTetrisBoardSnapshot* FTetrisSnapshotRing::Materialize(int32 Index)
+{
+    int32 Keyframe = Index;
+    while (!Get(Keyframe).Keyframe)
+    {
+        --Keyframe;
+    }
+
+    // Stepping forward continues from the entry already rebuilt
+    int32 From = Keyframe;
+    if (Cursor >= Keyframe && Cursor <= Index)
+    {
+        From = Cursor;
+    }
+    else
+    {
+        Current.Grid = *Get(Keyframe).Keyframe;
+    }
+    for (int32 Step = From + 1; Step <= Index; ++Step)
+    {
+        ApplyDelta(Get(Step).Delta, Current.Grid);
+    }
+
+    const FEntry& Entry = Get(Index);
+    Current.SpawnerState = Entry.SpawnerState;
+    Current.Score = Entry.Score;
+    Current.PieceNumber = Entry.PieceNumber;
+    Cursor = Index;
+    return &Current;
+}
+
+const FTetrisBoardSnapshot* FTetrisSnapshotRing::StepBack()
+{
+    return CanStepBack() ? Materialize(Cursor - 1) : nullptr;
+}
+
+const FTetrisBoardSnapshot* FTetrisSnapshotRing::StepForward()
+{
+    return CanStepForward() ? Materialize(Cursor + 1) : nullptr;
+}
+
+const FTetrisBoardSnapshot* FTetrisSnapshotRing::SeekTo(int32 PieceNumber)
+{
+    const int32 Index = Num > 0 ? PieceNumber - Get(0).PieceNumber : INDEX_NONE;
+    if (Index < 0 || Index >= Num)
+    {
+        return nullptr;
+    }
+    return Materialize(Index);
+}
+
+SIZE_T FTetrisSnapshotRing::GetAllocatedSize() const
+{
+    TSet<const void*> SeenChunks;
+    SIZE_T Size = Entries.GetAllocatedSize() + Current.Grid.GetUniqueAllocatedSize(SeenChunks);
+    for (int32 Index = 0; Index < Num; ++Index)
+    {
+        const FEntry& Entry = Get(Index);
+        Size += Entry.Delta.GetAllocatedSize();
+        if (Entry.Keyframe)
+        {
+            Size += sizeof(FTetrisBoardGrid) + Entry.Keyframe->GetUniqueAllocatedSize(SeenChunks);
+        }
+    }
+    return Size;
+}
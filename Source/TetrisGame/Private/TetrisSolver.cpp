@@ -0,0 +1,555 @@
+#include "TetrisSolver.h"
+#include "TetrisSimulation.h"
+#include "Async/ParallelFor.h"
+#include "Misc/ScopeLock.h"
+#include <atomic>
+
+namespace TetrisSolver
+{
+    static constexpr int32 NumMemoShards = 64;
+    // Caps the memo at about 2M states; past that, shards stop recording
+    static constexpr int32 MaxMemoEntriesPerShard = 1 << 15;
+
+    struct FMemoShard
+    {
+        FCriticalSection Lock;
+        TSet<uint64> DeadStates;
+    };
+
+    struct FPlacement
+    {
+        int32 Rotation = 0;
+        int32 X = 0;
+        int32 Y = 0;
+    };
+
+    struct FContext
+    {
+        FContext(const FTetrisSolverRequest& InRequest)
+            : Request(InRequest)
+            , Shapes(TetrisSimulation::GetStandardShapes())
+        {
+        }
+
+        const FTetrisSolverRequest& Request;
+        const TArray<FTetrisSimShape>& Shapes;
+
+        int32 Width = 0;
+        int32 Height = 0;
+        // Height plus room above the board to spawn and rotate
+        int32 PaddedHeight = 0;
+        uint64 RowMask = 0;
+        int32 PiecesToPlace = 0;
+        bool bPerfectClear = false;
+
+        // Column-parity bounds for the pieces from each queue position onwards
+        TArray<int32> SuffixMaxImbalance;
+        TArray<uint8> SuffixResidues;
+
+        double Deadline = 0.0;
+        std::atomic<bool> bStop{ false };
+        std::atomic<bool> bTimedOut{ false };
+        std::atomic<bool> bTruncated{ false };
+
+        FCriticalSection SolutionsLock;
+        TArray<FTetrisSolution> Solutions;
+
+        FMemoShard Shards[NumMemoShards];
+    };
+
+    struct FWorker
+    {
+        explicit FWorker(FContext& InContext)
+            : Context(InContext)
+        {
+            RowStack.SetNumZeroed((Context.PiecesToPlace + 1) * Context.PaddedHeight);
+            PlacementsPerDepth.SetNum(Context.PiecesToPlace);
+            Path.SetNum(Context.PiecesToPlace);
+        }
+
+        uint64* RowsAt(int32 Depth) { return RowStack.GetData() + Depth * Context.PaddedHeight; }
+
+        FContext& Context;
+        TArray<uint64> RowStack;
+        TArray<TArray<FPlacement>> PlacementsPerDepth;
+        TArray<FPlacement> Path;
+        TArray<uint8> Visited;
+        int64 Nodes = 0;
+        int64 MemoHits = 0;
+        int64 Pruned = 0;
+    };
+
+    static bool Fits(const uint64* Rows, const FTetrisSimRotation& Rotation, int32 X, int32 Y)
+    {
+        for (int32 Row = 0; Row < Rotation.Height; ++Row)
+        {
+            if (Rows[Y + Row] & (Rotation.RowBits[Row] << X))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Lock a piece and compact full rows away, returns the number cleared
+    static int32 Apply(uint64* Rows, int32 NumRows, uint64 RowMask, const FTetrisSimRotation& Rotation, int32 X, int32 Y)
+    {
+        for (int32 Row = 0; Row < Rotation.Height; ++Row)
+        {
+            Rows[Y + Row] |= Rotation.RowBits[Row] << X;
+        }
+
+        int32 Write = Y;
+        for (int32 Read = Y; Read < NumRows; ++Read)
+        {
+            if (Read >= Y + Rotation.Height || Rows[Read] != RowMask)
+            {
+                Rows[Write++] = Rows[Read];
+            }
+        }
+
+        const int32 Cleared = NumRows - Write;
+        for (; Write < NumRows; ++Write)
+        {
+            Rows[Write] = 0;
+        }
+        return Cleared;
+    }
+
+    static uint64 HashState(const uint64* Rows, int32 NumRows, int32 Depth, int32 Ceiling, int32 Lines)
+    {
+        uint64 Hash = (uint64(Depth) << 40) ^ (uint64(Ceiling) << 20) ^ uint64(Lines);
+        for (int32 Y = 0; Y < NumRows; ++Y)
+        {
+            Hash = (Hash ^ Rows[Y]) * 0x9E3779B97F4A7C15ull;
+            Hash ^= Hash >> 29;
+        }
+        return Hash;
+    }
+
+    // Even-column minus odd-column cell count of a rotation placed at an even X
+    static int32 ColumnImbalance(const FTetrisSimRotation& Rotation)
+    {
+        const uint64 EvenColumns = 0x5555555555555555ull;
+        int32 Imbalance = 0;
+        for (int32 Row = 0; Row < Rotation.Height; ++Row)
+        {
+            Imbalance += FMath::CountBits(Rotation.RowBits[Row] & EvenColumns) - FMath::CountBits(Rotation.RowBits[Row] & ~EvenColumns);
+        }
+        return Imbalance;
+    }
+
+    static void BuildParityTables(FContext& Context)
+    {
+        Context.SuffixMaxImbalance.SetNumZeroed(Context.PiecesToPlace + 1);
+        Context.SuffixResidues.SetNumZeroed(Context.PiecesToPlace + 1);
+        Context.SuffixResidues[Context.PiecesToPlace] = 1;
+
+        for (int32 Depth = Context.PiecesToPlace - 1; Depth >= 0; --Depth)
+        {
+            const FTetrisSimShape& Shape = Context.Shapes[static_cast<int32>(Context.Request.Queue[Depth])];
+
+            // A placement at an odd column flips the sign, so each rotation offers +v and -v
+            int32 MaxAbs = 0;
+            uint8 Residues = 0;
+            for (const FTetrisSimRotation& Rotation : Shape.Rotations)
+            {
+                const int32 Imbalance = ColumnImbalance(Rotation);
+                MaxAbs = FMath::Max(MaxAbs, FMath::Abs(Imbalance));
+                Residues |= 1 << (((Imbalance % 4) + 4) % 4);
+                Residues |= 1 << (((-Imbalance % 4) + 4) % 4);
+            }
+
+            uint8 Combined = 0;
+            for (int32 A = 0; A < 4; ++A)
+            {
+                for (int32 B = 0; B < 4; ++B)
+                {
+                    if ((Residues >> A) & (Context.SuffixResidues[Depth + 1] >> B) & 1)
+                    {
+                        Combined |= 1 << ((A + B) % 4);
+                    }
+                }
+            }
+            Context.SuffixResidues[Depth] = Combined;
+            Context.SuffixMaxImbalance[Depth] = Context.SuffixMaxImbalance[Depth + 1] + MaxAbs;
+        }
+    }
+
+    // Cheap necessary conditions for a perfect clear under the current ceiling
+    static bool CanStillPerfectClear(const FContext& Context, const uint64* Rows, int32 Ceiling, int32 Depth)
+    {
+        for (int32 Y = Ceiling; Y < Context.Height; ++Y)
+        {
+            if (Rows[Y] != 0)
+            {
+                return false;
+            }
+        }
+
+        // Remaining pieces land in the current empty cells, and line clears never move cells between columns
+        const uint64 EvenColumns = 0x5555555555555555ull & Context.RowMask;
+        const uint64 OddColumns = ~EvenColumns & Context.RowMask;
+        int32 Imbalance = 0;
+        for (int32 Y = 0; Y < Ceiling; ++Y)
+        {
+            const uint64 Empty = ~Rows[Y] & Context.RowMask;
+            Imbalance += FMath::CountBits(Empty & EvenColumns) - FMath::CountBits(Empty & OddColumns);
+        }
+        return FMath::Abs(Imbalance) <= Context.SuffixMaxImbalance[Depth]
+            && ((Context.SuffixResidues[Depth] >> (((Imbalance % 4) + 4) % 4)) & 1);
+    }
+
+    // Lock positions reachable by rotating at the spawn point and then moving left, right and down
+    static void GeneratePlacements(const FContext& Context, const uint64* Rows, const FTetrisSimShape& Shape, int32 TopLimit,
+        TArray<FPlacement>& OutPlacements, TArray<uint8>& Visited)
+    {
+        OutPlacements.Reset();
+        for (int32 RotationIndex = 0; RotationIndex < Shape.Rotations.Num(); ++RotationIndex)
+        {
+            const FTetrisSimRotation& Rotation = Shape.Rotations[RotationIndex];
+            const int32 MaxX = Context.Width - Rotation.Width;
+            const int32 MaxY = Context.PaddedHeight - Rotation.Height;
+            if (MaxX < 0)
+            {
+                continue;
+            }
+
+            const FIntPoint Spawn(MaxX / 2, MaxY);
+            if (!Fits(Rows, Rotation, Spawn.X, Spawn.Y))
+            {
+                continue;
+            }
+
+            // The buffer is shared by every rotation and search node, so clear it rather than just growing it
+            const int32 Stride = MaxX + 1;
+            Visited.Reset();
+            Visited.SetNumZeroed(Stride * (MaxY + 1));
+
+            TArray<FIntPoint, TInlineAllocator<64>> Open;
+            Open.Add(Spawn);
+            Visited[Spawn.Y * Stride + Spawn.X] = 1;
+            while (Open.Num() > 0)
+            {
+                const FIntPoint Position = Open.Pop(EAllowShrinking::No);
+                if (Position.Y == 0 || !Fits(Rows, Rotation, Position.X, Position.Y - 1))
+                {
+                    if (Position.Y + Rotation.Height <= TopLimit)
+                    {
+                        OutPlacements.Add({ RotationIndex, Position.X, Position.Y });
+                    }
+                }
+
+                const FIntPoint Moves[3] = { FIntPoint(-1, 0), FIntPoint(1, 0), FIntPoint(0, -1) };
+                for (const FIntPoint& Move : Moves)
+                {
+                    const FIntPoint Next = Position + Move;
+                    if (Next.X < 0 || Next.X > MaxX || Next.Y < 0 || Visited[Next.Y * Stride + Next.X])
+                    {
+                        continue;
+                    }
+                    Visited[Next.Y * Stride + Next.X] = 1;
+                    if (Fits(Rows, Rotation, Next.X, Next.Y))
+                    {
+                        Open.Add(Next);
+                    }
+                }
+            }
+        }
+    }
+
+    static void RecordSolution(FWorker& Worker, int32 NumSteps)
+    {
+        FContext& Context = Worker.Context;
+        FScopeLock Lock(&Context.SolutionsLock);
+        if (Context.bStop)
+        {
+            return;
+        }
+        if (Context.Request.bFindAll && Context.Solutions.Num() >= Context.Request.MaxSolutions)
+        {
+            // Only a solution past the cap proves the list is incomplete
+            Context.bTruncated = true;
+            Context.bStop = true;
+            return;
+        }
+
+        FTetrisSolution& Solution = Context.Solutions.AddDefaulted_GetRef();
+        for (int32 Step = 0; Step < NumSteps; ++Step)
+        {
+            const FPlacement& Placement = Worker.Path[Step];
+            const ETetrisPieceShape Shape = Context.Request.Queue[Step];
+            const FTetrisSimRotation& Rotation = Context.Shapes[static_cast<int32>(Shape)].Rotations[Placement.Rotation];
+
+            FTetrisSolverStep& OutStep = Solution.Steps.AddDefaulted_GetRef();
+            OutStep.Shape = Shape;
+            OutStep.Rotation = Placement.Rotation;
+            for (int32 Row = 0; Row < Rotation.Height; ++Row)
+            {
+                for (uint64 Bits = Rotation.RowBits[Row]; Bits; Bits &= Bits - 1)
+                {
+                    OutStep.Cells.Add(FIntPoint(Placement.X + static_cast<int32>(FMath::CountTrailingZeros64(Bits)), Placement.Y + Row));
+                }
+            }
+        }
+
+        if (!Context.Request.bFindAll)
+        {
+            Context.bStop = true;
+        }
+    }
+
+    // True if at least one solution was found below this state
+    static bool Search(FWorker& Worker, int32 Depth, int32 Ceiling, int32 Lines)
+    {
+        FContext& Context = Worker.Context;
+        const uint64* Rows = Worker.RowsAt(Depth);
+
+        if ((++Worker.Nodes & 1023) == 0 && Context.Deadline > 0.0 && FPlatformTime::Seconds() > Context.Deadline)
+        {
+            Context.bTimedOut = true;
+            Context.bStop = true;
+        }
+        if (Context.bStop)
+        {
+            return false;
+        }
+
+        if (Context.bPerfectClear)
+        {
+            if (Depth == Context.PiecesToPlace)
+            {
+                if (Ceiling == 0)
+                {
+                    RecordSolution(Worker, Depth);
+                    return true;
+                }
+                return false;
+            }
+            if (!CanStillPerfectClear(Context, Rows, Ceiling, Depth))
+            {
+                ++Worker.Pruned;
+                return false;
+            }
+        }
+        else
+        {
+            if (Lines >= Context.Request.LinesToClear)
+            {
+                RecordSolution(Worker, Depth);
+                return true;
+            }
+            if (Depth == Context.PiecesToPlace)
+            {
+                return false;
+            }
+        }
+
+        const uint64 Hash = HashState(Rows, Context.Height, Depth, Ceiling, Lines);
+        FMemoShard& Shard = Context.Shards[Hash >> 58];
+        {
+            FScopeLock Lock(&Shard.Lock);
+            if (Shard.DeadStates.Contains(Hash))
+            {
+                ++Worker.MemoHits;
+                return false;
+            }
+        }
+
+        TArray<FPlacement>& Placements = Worker.PlacementsPerDepth[Depth];
+        const FTetrisSimShape& Shape = Context.Shapes[static_cast<int32>(Context.Request.Queue[Depth])];
+        GeneratePlacements(Context, Rows, Shape, Ceiling, Placements, Worker.Visited);
+
+        bool bFound = false;
+        uint64* Child = Worker.RowsAt(Depth + 1);
+        for (const FPlacement& Placement : Placements)
+        {
+            FMemory::Memcpy(Child, Rows, Context.PaddedHeight * sizeof(uint64));
+            const int32 Cleared = Apply(Child, Context.PaddedHeight, Context.RowMask, Shape.Rotations[Placement.Rotation], Placement.X, Placement.Y);
+
+            Worker.Path[Depth] = Placement;
+            bFound |= Search(Worker, Depth + 1, Context.bPerfectClear ? Ceiling - Cleared : Ceiling, Lines + Cleared);
+            if (Context.bStop)
+            {
+                break;
+            }
+        }
+
+        // Only a fully explored dead end can be skipped next time
+        if (!bFound && !Context.bStop)
+        {
+            FScopeLock Lock(&Shard.Lock);
+            if (Shard.DeadStates.Num() < MaxMemoEntriesPerShard)
+            {
+                Shard.DeadStates.Add(Hash);
+            }
+        }
+        return bFound;
+    }
+
+    // Search one ceiling (the board height for ClearLines) and add what was found to Result
+    static void SolveWithCeiling(const FTetrisSolverRequest& Request, int32 Ceiling, int32 PiecesToPlace, double Deadline, FTetrisSolverResult& Result)
+    {
+        TUniquePtr<FContext> Context = MakeUnique<FContext>(Request);
+        Context->Width = Request.Width;
+        Context->Height = Request.Rows.Num();
+        Context->PaddedHeight = Context->Height + FTetrisSimRotation::MaxExtent;
+        Context->RowMask = Request.Width == 64 ? ~uint64(0) : (uint64(1) << Request.Width) - 1;
+        Context->PiecesToPlace = PiecesToPlace;
+        Context->bPerfectClear = Request.Goal == ETetrisSolverGoal::PerfectClear;
+        Context->Deadline = Deadline;
+        if (Context->bPerfectClear)
+        {
+            BuildParityTables(*Context);
+        }
+
+        // Expand the first level here and hand each subtree to a worker
+        FWorker Root(*Context);
+        for (int32 Y = 0; Y < Context->Height; ++Y)
+        {
+            Root.RowsAt(0)[Y] = Request.Rows[Y] & Context->RowMask;
+        }
+
+        TArray<FPlacement> RootPlacements;
+        const bool bRootSolved = !Context->bPerfectClear && Request.LinesToClear <= 0;
+        const bool bRootViable = !Context->bPerfectClear || CanStillPerfectClear(*Context, Root.RowsAt(0), Ceiling, 0);
+        if (bRootSolved)
+        {
+            RecordSolution(Root, 0);
+        }
+        else if (bRootViable)
+        {
+            const FTetrisSimShape& FirstShape = Context->Shapes[static_cast<int32>(Request.Queue[0])];
+            GeneratePlacements(*Context, Root.RowsAt(0), FirstShape, Ceiling, RootPlacements, Root.Visited);
+        }
+
+        std::atomic<int64> Nodes{ 1 };
+        std::atomic<int64> MemoHits{ 0 };
+        std::atomic<int64> Pruned{ bRootViable ? 0 : 1 };
+        ParallelFor(RootPlacements.Num(), [&](int32 Index)
+        {
+            if (Context->bStop)
+            {
+                return;
+            }
+
+            FWorker Worker(*Context);
+            FMemory::Memcpy(Worker.RowsAt(1), Root.RowsAt(0), Context->PaddedHeight * sizeof(uint64));
+
+            const FPlacement& Placement = RootPlacements[Index];
+            const FTetrisSimShape& FirstShape = Context->Shapes[static_cast<int32>(Request.Queue[0])];
+            const int32 Cleared = Apply(Worker.RowsAt(1), Context->PaddedHeight, Context->RowMask, FirstShape.Rotations[Placement.Rotation], Placement.X, Placement.Y);
+            Worker.Path[0] = Placement;
+            Search(Worker, 1, Context->bPerfectClear ? Ceiling - Cleared : Ceiling, Cleared);
+
+            Nodes += Worker.Nodes;
+            MemoHits += Worker.MemoHits;
+            Pruned += Worker.Pruned;
+        }, Request.bParallel ? EParallelForFlags::Unbalanced : EParallelForFlags::ForceSingleThread);
+
+        Result.Solutions.Append(MoveTemp(Context->Solutions));
+        Result.NodesVisited += Nodes;
+        Result.MemoHits += MemoHits;
+        Result.Pruned += Pruned;
+        Result.bTimedOut |= Context->bTimedOut.load();
+        Result.bTruncated |= Context->bTruncated.load();
+    }
+
+    FTetrisSolverResult Solve(const FTetrisSolverRequest& Request)
+    {
+        FTetrisSolverResult Result;
+        const double Start = FPlatformTime::Seconds();
+        const double Deadline = Request.TimeBudgetSeconds > 0.0 ? Start + Request.TimeBudgetSeconds : 0.0;
+
+        if (Request.Width <= 0 || Request.Width > 64 || Request.Rows.Num() == 0 || Request.Queue.Num() == 0)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("TetrisSolver::Solve - Need 1-64 columns, at least one row and a non-empty queue"));
+            return Result;
+        }
+
+        const int32 Height = Request.Rows.Num();
+        const uint64 RowMask = Request.Width == 64 ? ~uint64(0) : (uint64(1) << Request.Width) - 1;
+        int32 Filled = 0;
+        int32 StackHeight = 0;
+        for (int32 Y = 0; Y < Height; ++Y)
+        {
+            const uint64 Row = Request.Rows[Y] & RowMask;
+            Filled += FMath::CountBits(Row);
+            StackHeight = Row ? Y + 1 : StackHeight;
+        }
+
+        if (Request.Goal == ETetrisSolverGoal::ClearLines)
+        {
+            SolveWithCeiling(Request, Height, Request.Queue.Num(), Deadline, Result);
+        }
+        else
+        {
+            // With no height given, try each one the queue could fill from the lowest up
+            const int32 FirstCeiling = Request.LinesToClear > 0 ? Request.LinesToClear : FMath::Max(StackHeight, 1);
+            const int32 LastCeiling = Request.LinesToClear > 0 ? Request.LinesToClear : Height;
+            for (int32 Ceiling = FirstCeiling; Ceiling <= LastCeiling && Ceiling >= StackHeight && Ceiling <= Height; ++Ceiling)
+            {
+                const int32 Cells = Ceiling * Request.Width - Filled;
+                if (Cells / 4 > Request.Queue.Num())
+                {
+                    break;
+                }
+                if (Cells <= 0 || Cells % 4 != 0)
+                {
+                    continue;
+                }
+
+                SolveWithCeiling(Request, Ceiling, Cells / 4, Deadline, Result);
+                if (Result.Solutions.Num() > 0 || !Result.IsComplete())
+                {
+                    break;
+                }
+            }
+        }
+
+        // Workers finish in any order; sort so repeated runs list solutions identically
+        if (Request.bFindAll)
+        {
+            Result.Solutions.Sort([](const FTetrisSolution& A, const FTetrisSolution& B)
+            {
+                for (int32 Step = 0; Step < FMath::Min(A.Steps.Num(), B.Steps.Num()); ++Step)
+                {
+                    const TArray<FIntPoint>& CellsA = A.Steps[Step].Cells;
+                    const TArray<FIntPoint>& CellsB = B.Steps[Step].Cells;
+                    for (int32 Cell = 0; Cell < FMath::Min(CellsA.Num(), CellsB.Num()); ++Cell)
+                    {
+                        if (CellsA[Cell] != CellsB[Cell])
+                        {
+                            return CellsA[Cell].Y != CellsB[Cell].Y ? CellsA[Cell].Y < CellsB[Cell].Y : CellsA[Cell].X < CellsB[Cell].X;
+                        }
+                    }
+                }
+                return A.Steps.Num() < B.Steps.Num();
+            });
+        }
+
+        Result.Seconds = FPlatformTime::Seconds() - Start;
+        return Result;
+    }
+
+    bool ParseQueue(const FString& Text, TArray<ETetrisPieceShape>& OutQueue)
+    {
+        OutQueue.Reset();
+        for (TCHAR Char : Text)
+        {
+            switch (FChar::ToUpper(Char))
+            {
+            case TEXT('I'): OutQueue.Add(ETetrisPieceShape::I); break;
+            case TEXT('O'): OutQueue.Add(ETetrisPieceShape::O); break;
+            case TEXT('T'): OutQueue.Add(ETetrisPieceShape::T); break;
+            case TEXT('S'): OutQueue.Add(ETetrisPieceShape::S); break;
+            case TEXT('Z'): OutQueue.Add(ETetrisPieceShape::Z); break;
+            case TEXT('J'): OutQueue.Add(ETetrisPieceShape::J); break;
+            case TEXT('L'): OutQueue.Add(ETetrisPieceShape::L); break;
+            case TEXT(' '): case TEXT('\t'): case TEXT(','): break;
+            default: return false;
+            }
+        }
+        return true;
+    }
+}
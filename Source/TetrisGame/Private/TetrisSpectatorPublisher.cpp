@@ -0,0 +1,275 @@
+#include "TetrisSpectatorPublisher.h"
+#include "TetrisSpectatorServer.h"
+#include "TetrisBoard.h"
+#include "TetrisPiece.h"
+
+UTetrisSpectatorPublisher::UTetrisSpectatorPublisher()
+    : Stream(MakeShared<FTetrisSpectatorStream, ESPMode::ThreadSafe>())
+{
+    PrimaryComponentTick.bCanEverTick = false;
+}
+
+UTetrisSpectatorPublisher::~UTetrisSpectatorPublisher()
+{
+}
+
+void UTetrisSpectatorPublisher::BeginPlay()
+{
+    Super::BeginPlay();
+
+    Stream = MakeShared<FTetrisSpectatorStream, ESPMode::ThreadSafe>(RingCapacityBytes);
+
+    if (!Board)
+    {
+        Board = Cast<ATetrisBoard>(GetOwner());
+    }
+    BindBoard();
+
+    if (bListenTcp)
+    {
+        Server = MakeUnique<FTetrisSpectatorServer>(Stream, ListenPort, MaxSubscribers);
+        if (!Server->Start())
+        {
+            Server.Reset();
+        }
+    }
+}
+
+void UTetrisSpectatorPublisher::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    UnbindBoard();
+    Server.Reset();
+    Super::EndPlay(EndPlayReason);
+}
+
+void UTetrisSpectatorPublisher::SetBoard(ATetrisBoard* InBoard)
+{
+    if (Board == InBoard)
+    {
+        return;
+    }
+
+    UnbindBoard();
+    Board = InBoard;
+    if (HasBegunPlay())
+    {
+        BindBoard();
+    }
+}
+
+int32 UTetrisSpectatorPublisher::GetSubscriberCount() const
+{
+    return Server ? Server->GetSubscriberCount() : 0;
+}
+
+void UTetrisSpectatorPublisher::BindBoard()
+{
+    if (!Board)
+    {
+        return;
+    }
+
+    Board->OnBoardInitialized.AddDynamic(this, &UTetrisSpectatorPublisher::HandleBoardInitialized);
+    Board->OnPieceLocked.AddDynamic(this, &UTetrisSpectatorPublisher::HandlePieceLocked);
+    Board->OnLinesCleared.AddDynamic(this, &UTetrisSpectatorPublisher::HandleLinesCleared);
+    Board->OnNewPieceSpawned.AddDynamic(this, &UTetrisSpectatorPublisher::HandleNewPieceSpawned);
+    Board->OnGameOver.AddDynamic(this, &UTetrisSpectatorPublisher::HandleGameOver);
+    RevisionHandle = Board->OnBoardRevisionChanged.AddUObject(this, &UTetrisSpectatorPublisher::HandleBoardRevisionChanged);
+    RowsChangedHandle = Board->OnRowsChanged.AddUObject(this, &UTetrisSpectatorPublisher::HandleRowsChanged);
+
+    // Start every subscriber from whatever the board holds right now
+    HandleBoardInitialized(Board->Width, Board->Height);
+}
+
+void UTetrisSpectatorPublisher::UnbindBoard()
+{
+    if (!Board)
+    {
+        return;
+    }
+
+    Board->OnBoardInitialized.RemoveAll(this);
+    Board->OnPieceLocked.RemoveAll(this);
+    Board->OnLinesCleared.RemoveAll(this);
+    Board->OnNewPieceSpawned.RemoveAll(this);
+    Board->OnGameOver.RemoveAll(this);
+    Board->OnBoardRevisionChanged.Remove(RevisionHandle);
+    RevisionHandle.Reset();
+    Board->OnRowsChanged.Remove(RowsChangedHandle);
+    RowsChangedHandle.Reset();
+}
+
+void UTetrisSpectatorPublisher::HandleBoardInitialized(int32 InWidth, int32 InHeight)
+{
+    ShadowWidth = FMath::Max(InWidth, 0);
+    ShadowHeight = FMath::Max(InHeight, 0);
+    ShadowRows.Reset();
+    ShadowRows.SetNumZeroed(TetrisSpectator::BytesPerRow(ShadowWidth) * ShadowHeight);
+    LastActiveCells.Reset();
+    DirtyMinRow = 0;
+    DirtyMaxRow = ShadowHeight - 1;
+
+    Stream->Reset();
+    EmitRowDiff();
+    RefreshSnapshot();
+}
+
+void UTetrisSpectatorPublisher::HandlePieceLocked(ATetrisPiece* LockedPiece, FVector PieceLocation, FRotator PieceRotation)
+{
+    EmitRowDiff();
+
+    // Cleared before the frame goes out, so a snapshot it triggers shows no falling piece
+    LastActiveCells.Reset();
+    EmitPieceCells(ETetrisSpectatorFrame::PieceLocked, LockedPiece);
+}
+
+void UTetrisSpectatorPublisher::HandleLinesCleared(int32 LinesCleared, int32 NewScore)
+{
+    EmitRowDiff();
+
+    Scratch.Reset();
+    Write<uint8>(static_cast<uint8>(FMath::Clamp(LinesCleared, 0, 255)));
+    Write<int32>(NewScore);
+    Append(ETetrisSpectatorFrame::LinesCleared);
+}
+
+void UTetrisSpectatorPublisher::HandleNewPieceSpawned(ATetrisPiece* NewPiece)
+{
+    EmitRowDiff();
+    if (Board)
+    {
+        Board->GetPieceCells(NewPiece, LastActiveCells);
+    }
+    EmitPieceCells(ETetrisSpectatorFrame::PieceSpawned, NewPiece);
+}
+
+void UTetrisSpectatorPublisher::HandleGameOver()
+{
+    EmitRowDiff();
+    Scratch.Reset();
+    Append(ETetrisSpectatorFrame::GameOver);
+}
+
+void UTetrisSpectatorPublisher::HandleBoardRevisionChanged(uint32 Revision)
+{
+    EmitRowDiff();
+    EmitActivePiece();
+}
+
+void UTetrisSpectatorPublisher::HandleRowsChanged(int32 MinRow, int32 MaxRow)
+{
+    if (DirtyMaxRow < DirtyMinRow)
+    {
+        DirtyMinRow = MinRow;
+        DirtyMaxRow = MaxRow;
+    }
+    else
+    {
+        DirtyMinRow = FMath::Min(DirtyMinRow, MinRow);
+        DirtyMaxRow = FMath::Max(DirtyMaxRow, MaxRow);
+    }
+}
+
+void UTetrisSpectatorPublisher::EmitRowDiff()
+{
+    if (!Board || ShadowWidth <= 0 || ShadowHeight <= 0)
+    {
+        return;
+    }
+
+    // Nothing to publish until the board has allocated its grid
+    const FTetrisBoardGrid& Grid = Board->GetGrid();
+    if (Grid.GetHeight() == 0)
+    {
+        return;
+    }
+
+    if (Grid.GetWidth() != ShadowWidth || Grid.GetHeight() != ShadowHeight)
+    {
+        HandleBoardInitialized(Grid.GetWidth(), Grid.GetHeight());
+        return;
+    }
+
+    if (DirtyMaxRow < DirtyMinRow)
+    {
+        return;
+    }
+
+    Scratch.Reset();
+    const int32 ChangedRows = TetrisSpectator::EncodeRowDiff(Grid, DirtyMinRow, DirtyMaxRow, ShadowRows, Scratch);
+    DirtyMinRow = 0;
+    DirtyMaxRow = -1;
+    if (ChangedRows > 0)
+    {
+        Append(ETetrisSpectatorFrame::RowsChanged);
+    }
+}
+
+void UTetrisSpectatorPublisher::EmitActivePiece()
+{
+    if (!Board)
+    {
+        return;
+    }
+
+    Board->GetPieceCells(Board->CurrentPiece, ScratchCells);
+    if (ScratchCells == LastActiveCells)
+    {
+        return;
+    }
+
+    LastActiveCells = ScratchCells;
+    EmitPieceCells(ETetrisSpectatorFrame::ActivePiece, Board->CurrentPiece);
+}
+
+void UTetrisSpectatorPublisher::EmitPieceCells(ETetrisSpectatorFrame Type, ATetrisPiece* Piece)
+{
+    if (!Board)
+    {
+        return;
+    }
+
+    Board->GetPieceCells(Piece, ScratchCells);
+
+    Scratch.Reset();
+    WriteCells(ScratchCells);
+    Append(Type);
+}
+
+void UTetrisSpectatorPublisher::WriteCells(const TArray<FIntPoint>& Cells)
+{
+    const int32 Count = FMath::Min(Cells.Num(), 255);
+    Write<uint8>(static_cast<uint8>(Count));
+    for (int32 Index = 0; Index < Count; ++Index)
+    {
+        Write<int16>(static_cast<int16>(Cells[Index].X));
+        Write<int16>(static_cast<int16>(Cells[Index].Y));
+    }
+}
+
+void UTetrisSpectatorPublisher::RefreshSnapshot()
+{
+    Scratch.Reset();
+    Write<uint16>(static_cast<uint16>(ShadowWidth));
+    Write<uint16>(static_cast<uint16>(ShadowHeight));
+    Write<int32>(Board ? Board->CurrentScore : 0);
+    Scratch.Append(ShadowRows);
+
+    // Without this a late joiner sees no falling piece until it next moves
+    WriteCells(LastActiveCells);
+
+    Stream->SetSnapshot(Scratch.GetData(), Scratch.Num());
+    FramesSinceSnapshot = 0;
+}
+
+void UTetrisSpectatorPublisher::Append(ETetrisSpectatorFrame Type)
+{
+    Stream->Append(Type, Scratch.GetData(), Scratch.Num());
+
+    // Keep the snapshot inside the ring so late joiners can always pick up its tail
+    ++FramesSinceSnapshot;
+    if (FramesSinceSnapshot >= static_cast<uint32>(SnapshotInterval) || Stream->GetSnapshotSequence() < Stream->GetTailSequence())
+    {
+        RefreshSnapshot();
+    }
+}
@@ -0,0 +1,164 @@
+#include "TetrisSpectatorServer.h"
+#include "Common/TcpSocketBuilder.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/PlatformProcess.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+
+namespace TetrisSpectatorServer
+{
+    // Bytes pulled from the ring per subscriber per pass, keeps one slow client from hogging the loop
+    constexpr int32 MaxBytesPerPass = 64 * 1024;
+
+    // Idle sleep when no subscriber had anything to send
+    constexpr float IdleSleepSeconds = 0.002f;
+}
+
+FTetrisSpectatorServer::FTetrisSpectatorServer(TSharedRef<FTetrisSpectatorStream, ESPMode::ThreadSafe> InStream, int32 InPort, int32 InMaxSubscribers)
+    : Stream(InStream)
+    , Port(InPort)
+    , MaxSubscribers(InMaxSubscribers)
+{
+}
+
+FTetrisSpectatorServer::~FTetrisSpectatorServer()
+{
+    if (Thread)
+    {
+        Thread->Kill(true);
+        delete Thread;
+        Thread = nullptr;
+    }
+
+    for (FSubscriber& Subscriber : Subscribers)
+    {
+        CloseSubscriber(Subscriber);
+    }
+    Subscribers.Reset();
+
+    if (ListenSocket)
+    {
+        ListenSocket->Close();
+        ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(ListenSocket);
+        ListenSocket = nullptr;
+    }
+}
+
+bool FTetrisSpectatorServer::Start()
+{
+    ListenSocket = FTcpSocketBuilder(TEXT("TetrisSpectatorListen"))
+        .AsReusable()
+        .AsNonBlocking()
+        .BoundToAddress(FIPv4Address(127, 0, 0, 1))
+        .BoundToPort(Port)
+        .Listening(64)
+        .Build();
+
+    if (!ListenSocket)
+    {
+        UE_LOG(LogTemp, Error, TEXT("TetrisSpectatorServer::Start - Failed to listen on port %d"), Port);
+        return false;
+    }
+
+    Thread = FRunnableThread::Create(this, TEXT("TetrisSpectatorServer"), 0, TPri_BelowNormal);
+    return Thread != nullptr;
+}
+
+void FTetrisSpectatorServer::Stop()
+{
+    bStopping = true;
+}
+
+uint32 FTetrisSpectatorServer::Run()
+{
+    while (!bStopping)
+    {
+        AcceptPending();
+
+        bool bDidWork = false;
+        for (int32 Index = Subscribers.Num() - 1; Index >= 0; --Index)
+        {
+            if (!Pump(Subscribers[Index], bDidWork))
+            {
+                CloseSubscriber(Subscribers[Index]);
+                Subscribers.RemoveAtSwap(Index);
+            }
+        }
+        SubscriberCount = Subscribers.Num();
+
+        if (!bDidWork)
+        {
+            FPlatformProcess::Sleep(TetrisSpectatorServer::IdleSleepSeconds);
+        }
+    }
+    return 0;
+}
+
+void FTetrisSpectatorServer::AcceptPending()
+{
+    bool bHasPending = false;
+    while (ListenSocket->HasPendingConnection(bHasPending) && bHasPending)
+    {
+        FSocket* Client = ListenSocket->Accept(TEXT("TetrisSpectatorClient"));
+        if (!Client)
+        {
+            break;
+        }
+
+        if (Subscribers.Num() >= MaxSubscribers)
+        {
+            Client->Close();
+            ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Client);
+            continue;
+        }
+
+        Client->SetNonBlocking(true);
+        Client->SetNoDelay(true);
+
+        FSubscriber& Subscriber = Subscribers.AddDefaulted_GetRef();
+        Subscriber.Socket = Client;
+    }
+}
+
+bool FTetrisSpectatorServer::Pump(FSubscriber& Subscriber, bool& bOutDidWork)
+{
+    if (Subscriber.Socket->GetConnectionState() == SCS_ConnectionError)
+    {
+        return false;
+    }
+
+    // Refill from the shared ring once the previous batch has been fully sent
+    if (Subscriber.PendingOffset >= Subscriber.Pending.Num())
+    {
+        Subscriber.Pending.Reset();
+        Subscriber.PendingOffset = 0;
+        Subscriber.Cursor.Poll(*Stream, Subscriber.Pending, TetrisSpectatorServer::MaxBytesPerPass);
+    }
+
+    const int32 Remaining = Subscriber.Pending.Num() - Subscriber.PendingOffset;
+    if (Remaining <= 0)
+    {
+        return true;
+    }
+
+    int32 BytesSent = 0;
+    if (!Subscriber.Socket->Send(Subscriber.Pending.GetData() + Subscriber.PendingOffset, Remaining, BytesSent))
+    {
+        // Would-block just means the client's window is full; anything else drops it
+        return ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->GetLastErrorCode() == SE_EWOULDBLOCK;
+    }
+
+    Subscriber.PendingOffset += BytesSent;
+    bOutDidWork |= BytesSent > 0;
+    return true;
+}
+
+void FTetrisSpectatorServer::CloseSubscriber(FSubscriber& Subscriber)
+{
+    if (Subscriber.Socket)
+    {
+        Subscriber.Socket->Close();
+        ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Subscriber.Socket);
+        Subscriber.Socket = nullptr;
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "TetrisSpectatorStream.h"
+
+class FSocket;
+class FRunnableThread;
+
+/*
+ * Loopback TCP fan-out for a spectator stream.
+ * A single worker thread accepts connections and copies already-encoded frames to each one;
+ * nothing is re-encoded per subscriber, so adding observers only adds memcpy and send cost.
+ */
+class FTetrisSpectatorServer : public FRunnable
+{
+public:
+    FTetrisSpectatorServer(TSharedRef<FTetrisSpectatorStream, ESPMode::ThreadSafe> InStream, int32 InPort, int32 InMaxSubscribers);
+    virtual ~FTetrisSpectatorServer();
+
+    // Bind the listen socket and start the worker thread
+    bool Start();
+
+    int32 GetSubscriberCount() const { return SubscriberCount; }
+
+    // FRunnable interface
+    virtual uint32 Run() override;
+    virtual void Stop() override;
+
+private:
+    struct FSubscriber
+    {
+        FSocket* Socket = nullptr;
+        FTetrisSpectatorCursor Cursor;
+        TArray<uint8> Pending;
+        int32 PendingOffset = 0;
+    };
+
+    void AcceptPending();
+
+    // Top up and flush one subscriber; returns false once the connection is gone
+    bool Pump(FSubscriber& Subscriber, bool& bOutDidWork);
+
+    void CloseSubscriber(FSubscriber& Subscriber);
+
+    TSharedRef<FTetrisSpectatorStream, ESPMode::ThreadSafe> Stream;
+    int32 Port;
+    int32 MaxSubscribers;
+
+    FSocket* ListenSocket = nullptr;
+    FRunnableThread* Thread = nullptr;
+    TArray<FSubscriber> Subscribers;
+
+    std::atomic<bool> bStopping { false };
+    std::atomic<int32> SubscriberCount { 0 };
+};
@@ -0,0 +1,222 @@
+#include "TetrisSpectatorStream.h"
+#include "TetrisBoardGrid.h"
+#include "Misc/ScopeRWLock.h"
+
+namespace TetrisSpectator
+{
+    static void WriteHeader(uint8* Dest, uint32 FrameSize, uint32 Sequence, ETetrisSpectatorFrame Type)
+    {
+        FMemory::Memcpy(Dest, &FrameSize, sizeof(uint32));
+        FMemory::Memcpy(Dest + sizeof(uint32), &Sequence, sizeof(uint32));
+        Dest[2 * sizeof(uint32)] = static_cast<uint8>(Type);
+    }
+
+    int32 EncodeRowDiff(const FTetrisBoardGrid& Grid, int32 MinRow, int32 MaxRow, TArray<uint8>& ShadowRows, TArray<uint8>& Out)
+    {
+        // Packed grid words are little-endian, so their leading bytes are already the wire row
+        static_assert(PLATFORM_LITTLE_ENDIAN, "Spectator row packing assumes little-endian words");
+
+        const int32 RowBytes = BytesPerRow(Grid.GetWidth());
+        MinRow = FMath::Max(MinRow, 0);
+        MaxRow = FMath::Min3(MaxRow, Grid.GetHeight() - 1, ShadowRows.Num() / FMath::Max(RowBytes, 1) - 1);
+
+        const int32 CountAt = Out.AddUninitialized(sizeof(uint16));
+        uint16 ChangedRows = 0;
+        for (int32 Y = MinRow; Y <= MaxRow; ++Y)
+        {
+            const uint8* Row = reinterpret_cast<const uint8*>(Grid.GetRow(Y));
+            uint8* Shadow = ShadowRows.GetData() + Y * RowBytes;
+            if (FMemory::Memcmp(Shadow, Row, RowBytes) != 0)
+            {
+                FMemory::Memcpy(Shadow, Row, RowBytes);
+                const uint16 Y16 = static_cast<uint16>(Y);
+                Out.Append(reinterpret_cast<const uint8*>(&Y16), sizeof(uint16));
+                Out.Append(Row, RowBytes);
+                ++ChangedRows;
+            }
+        }
+
+        if (ChangedRows == 0)
+        {
+            Out.SetNum(CountAt, EAllowShrinking::No);
+            return 0;
+        }
+        FMemory::Memcpy(Out.GetData() + CountAt, &ChangedRows, sizeof(uint16));
+        return ChangedRows;
+    }
+}
+
+FTetrisSpectatorStream::FTetrisSpectatorStream(int32 InCapacityBytes, int32 InMaxFrames)
+{
+    Buffer.SetNumZeroed(FMath::Max(InCapacityBytes, 1024));
+    Frames.SetNumZeroed(FMath::Max(InMaxFrames, 16));
+}
+
+void FTetrisSpectatorStream::Reset()
+{
+    FRWScopeLock ScopeLock(Lock, SLT_Write);
+
+    // Skip a sequence number: a reader sitting at the old head would otherwise read on into
+    // frames for a board that may not even have the same dimensions any more
+    ++HeadSequence;
+    TailSequence = HeadSequence;
+    SnapshotBytes.Reset();
+    SnapshotSequence = HeadSequence;
+}
+
+void FTetrisSpectatorStream::EvictFor(uint32 FrameSize)
+{
+    const uint64 Capacity = Buffer.Num();
+    while (TailSequence != HeadSequence)
+    {
+        const FFrameRef& Oldest = Frames[TailSequence % Frames.Num()];
+        const bool bRoomForBytes = WriteOffset + FrameSize - Oldest.Offset <= Capacity;
+        const bool bRoomForFrame = HeadSequence - TailSequence < static_cast<uint32>(Frames.Num());
+        if (bRoomForBytes && bRoomForFrame)
+        {
+            break;
+        }
+        ++TailSequence;
+    }
+}
+
+uint32 FTetrisSpectatorStream::Append(ETetrisSpectatorFrame Type, const uint8* Payload, int32 PayloadSize)
+{
+    const uint32 FrameSize = TetrisSpectator::FrameHeaderSize + PayloadSize;
+    if (!ensureMsgf(FrameSize <= static_cast<uint32>(Buffer.Num()), TEXT("Spectator frame larger than the ring")))
+    {
+        return HeadSequence;
+    }
+
+    FRWScopeLock ScopeLock(Lock, SLT_Write);
+    EvictFor(FrameSize);
+
+    uint8 Header[TetrisSpectator::FrameHeaderSize];
+    TetrisSpectator::WriteHeader(Header, FrameSize, HeadSequence, Type);
+
+    // Copy header and payload into the ring, wrapping at the end of the buffer
+    const uint64 Capacity = Buffer.Num();
+    auto WriteBytes = [this, Capacity](uint64 At, const uint8* Src, uint32 Size)
+    {
+        const uint32 Start = static_cast<uint32>(At % Capacity);
+        const uint32 FirstPart = FMath::Min<uint32>(Size, static_cast<uint32>(Capacity - Start));
+        FMemory::Memcpy(Buffer.GetData() + Start, Src, FirstPart);
+        if (FirstPart < Size)
+        {
+            FMemory::Memcpy(Buffer.GetData(), Src + FirstPart, Size - FirstPart);
+        }
+    };
+    WriteBytes(WriteOffset, Header, TetrisSpectator::FrameHeaderSize);
+    if (PayloadSize > 0)
+    {
+        WriteBytes(WriteOffset + TetrisSpectator::FrameHeaderSize, Payload, PayloadSize);
+    }
+
+    Frames[HeadSequence % Frames.Num()] = { WriteOffset, FrameSize };
+    WriteOffset += FrameSize;
+    return HeadSequence++;
+}
+
+void FTetrisSpectatorStream::SetSnapshot(const uint8* Payload, int32 PayloadSize)
+{
+    FRWScopeLock ScopeLock(Lock, SLT_Write);
+    const uint32 FrameSize = TetrisSpectator::FrameHeaderSize + PayloadSize;
+    SnapshotBytes.Reset(FrameSize);
+    SnapshotBytes.AddUninitialized(FrameSize);
+    TetrisSpectator::WriteHeader(SnapshotBytes.GetData(), FrameSize, HeadSequence, ETetrisSpectatorFrame::Snapshot);
+    if (PayloadSize > 0)
+    {
+        FMemory::Memcpy(SnapshotBytes.GetData() + TetrisSpectator::FrameHeaderSize, Payload, PayloadSize);
+    }
+    SnapshotSequence = HeadSequence;
+}
+
+bool FTetrisSpectatorStream::GetSnapshot(TArray<uint8>& OutBytes, uint32& OutNextSequence) const
+{
+    FRWScopeLock ScopeLock(Lock, SLT_ReadOnly);
+    if (SnapshotBytes.Num() == 0)
+    {
+        return false;
+    }
+    OutBytes.Append(SnapshotBytes);
+    OutNextSequence = SnapshotSequence;
+    return true;
+}
+
+void FTetrisSpectatorStream::CopyOut(uint64 Offset, uint32 Size, uint8* Dest) const
+{
+    const uint64 Capacity = Buffer.Num();
+    const uint32 Start = static_cast<uint32>(Offset % Capacity);
+    const uint32 FirstPart = FMath::Min<uint32>(Size, static_cast<uint32>(Capacity - Start));
+    FMemory::Memcpy(Dest, Buffer.GetData() + Start, FirstPart);
+    if (FirstPart < Size)
+    {
+        FMemory::Memcpy(Dest + FirstPart, Buffer.GetData(), Size - FirstPart);
+    }
+}
+
+bool FTetrisSpectatorStream::ReadFrom(uint32 FromSequence, TArray<uint8>& OutBytes, uint32& OutNextSequence, int32 MaxBytes) const
+{
+    FRWScopeLock ScopeLock(Lock, SLT_ReadOnly);
+    if (FromSequence < TailSequence || FromSequence > HeadSequence)
+    {
+        return false;
+    }
+
+    int32 Budget = MaxBytes;
+    uint32 Sequence = FromSequence;
+    while (Sequence != HeadSequence)
+    {
+        const FFrameRef& Frame = Frames[Sequence % Frames.Num()];
+        if (static_cast<int32>(Frame.Size) > Budget && Sequence != FromSequence)
+        {
+            break;
+        }
+
+        const int32 At = OutBytes.AddUninitialized(Frame.Size);
+        CopyOut(Frame.Offset, Frame.Size, OutBytes.GetData() + At);
+        Budget -= Frame.Size;
+        ++Sequence;
+    }
+
+    OutNextSequence = Sequence;
+    return true;
+}
+
+uint32 FTetrisSpectatorStream::GetHeadSequence() const
+{
+    FRWScopeLock ScopeLock(Lock, SLT_ReadOnly);
+    return HeadSequence;
+}
+
+uint32 FTetrisSpectatorStream::GetTailSequence() const
+{
+    FRWScopeLock ScopeLock(Lock, SLT_ReadOnly);
+    return TailSequence;
+}
+
+uint32 FTetrisSpectatorStream::GetSnapshotSequence() const
+{
+    FRWScopeLock ScopeLock(Lock, SLT_ReadOnly);
+    return SnapshotSequence;
+}
+
+void FTetrisSpectatorCursor::Poll(const FTetrisSpectatorStream& Stream, TArray<uint8>& OutBytes, int32 MaxBytes)
+{
+    uint32 Next = 0;
+    if (NextSequence != INDEX_NONE && Stream.ReadFrom(static_cast<uint32>(NextSequence), OutBytes, Next, MaxBytes))
+    {
+        NextSequence = Next;
+        return;
+    }
+
+    // Joining late or fell behind the ring: resync from the snapshot, then read its tail
+    if (Stream.GetSnapshot(OutBytes, Next))
+    {
+        NextSequence = Next;
+        if (Stream.ReadFrom(Next, OutBytes, Next, MaxBytes))
+        {
+            NextSequence = Next;
+        }
+    }
+}
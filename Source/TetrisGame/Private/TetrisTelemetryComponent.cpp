@@ -0,0 +1,323 @@
+#include "TetrisTelemetryComponent.h"
+#include "TetrisBoard.h"
+#include "TetrisPiece.h"
+#include "Async/Async.h"
+#include "HAL/FileManager.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Guid.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "TimerManager.h"
+
+CSV_DEFINE_CATEGORY(Tetris, true);
+
+namespace TetrisTelemetry
+{
+    // Garbage lines sent for 0..4 lines cleared
+    constexpr uint64 AttackTable[] = { 0, 0, 1, 2, 4 };
+
+    static uint64 CyclesToMicroseconds(uint64 Cycles)
+    {
+        return static_cast<uint64>(FPlatformTime::ToSeconds64(Cycles) * 1000000.0);
+    }
+
+    // Every component's appends go through one queue drained by a single task at a time, so
+    // rows land in the order they were flushed and never interleave
+    struct FWriteQueue
+    {
+        FCriticalSection Lock;
+        TArray<TPair<FString, FString>> Pending;
+        bool bDraining = false;
+    };
+
+    static FWriteQueue& GetWriteQueue()
+    {
+        static FWriteQueue Queue;
+        return Queue;
+    }
+
+    static void DrainWrites()
+    {
+        FWriteQueue& Queue = GetWriteQueue();
+        TArray<TPair<FString, FString>> Writes;
+        for (;;)
+        {
+            {
+                FScopeLock Lock(&Queue.Lock);
+                if (Queue.Pending.Num() == 0)
+                {
+                    Queue.bDraining = false;
+                    return;
+                }
+                Swap(Writes, Queue.Pending);
+            }
+            for (const TPair<FString, FString>& Write : Writes)
+            {
+                FFileHelper::SaveStringToFile(Write.Value, *Write.Key, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM, &IFileManager::Get(), FILEWRITE_Append);
+            }
+            Writes.Reset();
+        }
+    }
+
+    static void QueueAppend(const FString& Path, FString&& Text)
+    {
+        FWriteQueue& Queue = GetWriteQueue();
+        FScopeLock Lock(&Queue.Lock);
+        Queue.Pending.Emplace(Path, MoveTemp(Text));
+        if (!Queue.bDraining)
+        {
+            Queue.bDraining = true;
+            AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, &DrainWrites);
+        }
+    }
+}
+
+UTetrisTelemetryComponent::UTetrisTelemetryComponent()
+{
+    PrimaryComponentTick.bCanEverTick = false;
+}
+
+void UTetrisTelemetryComponent::BeginPlay()
+{
+    Super::BeginPlay();
+    StartGame();
+
+    Board = Cast<ATetrisBoard>(GetOwner());
+    if (Board)
+    {
+        Board->OnBoardInitialized.AddDynamic(this, &UTetrisTelemetryComponent::HandleBoardInitialized);
+        Board->OnGameOver.AddDynamic(this, &UTetrisTelemetryComponent::HandleGameOver);
+        Board->OnNewPieceSpawned.AddDynamic(this, &UTetrisTelemetryComponent::HandleNewPieceSpawned);
+        Board->OnPieceLocked.AddDynamic(this, &UTetrisTelemetryComponent::HandlePieceLocked);
+        Board->OnRowsCleared.AddUObject(this, &UTetrisTelemetryComponent::HandleRowsCleared);
+    }
+
+    if (FlushInterval > 0.f)
+    {
+        GetWorld()->GetTimerManager().SetTimer(FlushTimerHandle, this, &UTetrisTelemetryComponent::Flush, FlushInterval, true);
+    }
+}
+
+void UTetrisTelemetryComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (UWorld* World = GetWorld())
+    {
+        World->GetTimerManager().ClearTimer(FlushTimerHandle);
+    }
+
+    if (Board)
+    {
+        Board->OnBoardInitialized.RemoveAll(this);
+        Board->OnGameOver.RemoveAll(this);
+        Board->OnNewPieceSpawned.RemoveAll(this);
+        Board->OnPieceLocked.RemoveAll(this);
+        Board->OnRowsCleared.RemoveAll(this);
+    }
+
+    Flush();
+    Super::EndPlay(EndPlayReason);
+}
+
+void UTetrisTelemetryComponent::StartGame()
+{
+    if (StartCycles != 0)
+    {
+        Flush();
+    }
+
+    StartCycles = 0;
+    Pieces.store(0, std::memory_order_relaxed);
+    Actions.store(0, std::memory_order_relaxed);
+    FinesseFaults.store(0, std::memory_order_relaxed);
+    Lines.store(0, std::memory_order_relaxed);
+    Attack.store(0, std::memory_order_relaxed);
+    PlacementTimeUs.Reset();
+    InputToLockUs.Reset();
+    PieceStartCycles = 0;
+    LastInputCycles = 0;
+    PieceShift = 0;
+    PieceRotations = 0;
+    PieceMoveInputs = 0;
+
+    // Boards that start in the same second still get their own file
+    GameId = FString::Printf(TEXT("TetrisTelemetry_%s_%s_%s"), *GetOwner()->GetName(),
+        *FDateTime::UtcNow().ToString(TEXT("%Y%m%d-%H%M%S")), *FGuid::NewGuid().ToString(EGuidFormats::Digits).Left(8));
+    OutputPath = FPaths::ProjectSavedDir() / TEXT("Telemetry") / GameId + (Sink == ETetrisTelemetrySink::Json ? TEXT(".jsonl") : TEXT(".csv"));
+    bWroteCsvHeader = false;
+}
+
+void UTetrisTelemetryComponent::HandleBoardInitialized(int32 Width, int32 Height)
+{
+    StartGame();
+}
+
+void UTetrisTelemetryComponent::HandleGameOver()
+{
+    StartGame();
+}
+
+void UTetrisTelemetryComponent::RecordAction(ETetrisInputAction Action)
+{
+    // Inputs before the first spawn are not part of a game
+    if (StartCycles == 0)
+    {
+        return;
+    }
+
+    const uint64 Now = FPlatformTime::Cycles64();
+    if (PieceStartCycles == 0)
+    {
+        PieceStartCycles = Now;
+    }
+    LastInputCycles = Now;
+    Actions.fetch_add(1, std::memory_order_relaxed);
+
+    switch (Action)
+    {
+    case ETetrisInputAction::MoveLeft:
+        --PieceShift;
+        ++PieceMoveInputs;
+        break;
+    case ETetrisInputAction::MoveRight:
+        ++PieceShift;
+        ++PieceMoveInputs;
+        break;
+    case ETetrisInputAction::Rotate:
+        ++PieceRotations;
+        ++PieceMoveInputs;
+        break;
+    default:
+        break;
+    }
+}
+
+void UTetrisTelemetryComponent::HandleNewPieceSpawned(ATetrisPiece* NewPiece)
+{
+    PieceStartCycles = FPlatformTime::Cycles64();
+    if (StartCycles == 0)
+    {
+        StartCycles = PieceStartCycles;
+    }
+    LastInputCycles = 0;
+    PieceShift = 0;
+    PieceRotations = 0;
+    PieceMoveInputs = 0;
+}
+
+void UTetrisTelemetryComponent::HandlePieceLocked(ATetrisPiece* LockedPiece, FVector PieceLocation, FRotator PieceRotation)
+{
+    const uint64 Now = FPlatformTime::Cycles64();
+    Pieces.fetch_add(1, std::memory_order_relaxed);
+
+    if (PieceStartCycles != 0)
+    {
+        PlacementTimeUs.Record(TetrisTelemetry::CyclesToMicroseconds(Now - PieceStartCycles));
+    }
+    if (LastInputCycles != 0)
+    {
+        InputToLockUs.Record(TetrisTelemetry::CyclesToMicroseconds(Now - LastInputCycles));
+    }
+
+    // Finesse approximation: only clockwise rotation exists, so the cheapest route to the final
+    // placement is |net shift| taps plus (net rotations mod 4) rotations. Anything more is a fault.
+    const int32 MinimalInputs = FMath::Abs(PieceShift) + (PieceRotations % 4);
+    if (PieceMoveInputs > MinimalInputs)
+    {
+        FinesseFaults.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    PieceStartCycles = 0;
+    LastInputCycles = 0;
+    PieceShift = 0;
+    PieceRotations = 0;
+    PieceMoveInputs = 0;
+}
+
+void UTetrisTelemetryComponent::HandleRowsCleared(int32 LinesCleared)
+{
+    if (LinesCleared <= 0)
+    {
+        return;
+    }
+
+    Lines.fetch_add(LinesCleared, std::memory_order_relaxed);
+    Attack.fetch_add(TetrisTelemetry::AttackTable[FMath::Min(LinesCleared, 4)], std::memory_order_relaxed);
+}
+
+double UTetrisTelemetryComponent::SecondsSinceStart() const
+{
+    return StartCycles != 0 ? FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles) : 0.0;
+}
+
+float UTetrisTelemetryComponent::GetPiecesPerSecond() const
+{
+    const double Seconds = SecondsSinceStart();
+    return Seconds > 0.0 ? static_cast<float>(Pieces.load(std::memory_order_relaxed) / Seconds) : 0.f;
+}
+
+float UTetrisTelemetryComponent::GetActionsPerMinute() const
+{
+    const double Seconds = SecondsSinceStart();
+    return Seconds > 0.0 ? static_cast<float>(Actions.load(std::memory_order_relaxed) * 60.0 / Seconds) : 0.f;
+}
+
+void UTetrisTelemetryComponent::Flush()
+{
+    if (StartCycles == 0)
+    {
+        return;
+    }
+
+    const double Seconds = SecondsSinceStart();
+    const float Pps = GetPiecesPerSecond();
+    const float Apm = GetActionsPerMinute();
+    const uint64 PieceCount = Pieces.load(std::memory_order_relaxed);
+    const uint64 FaultCount = FinesseFaults.load(std::memory_order_relaxed);
+    const uint64 LineCount = Lines.load(std::memory_order_relaxed);
+    const uint64 AttackCount = Attack.load(std::memory_order_relaxed);
+    const FTetrisHistogram::FSummary Placement = PlacementTimeUs.Summarize();
+    const FTetrisHistogram::FSummary Latency = InputToLockUs.Summarize();
+
+    if (Sink == ETetrisTelemetrySink::CsvProfiler)
+    {
+        CSV_CUSTOM_STAT(Tetris, PiecesPerSecond, Pps, ECsvCustomStatOp::Set);
+        CSV_CUSTOM_STAT(Tetris, ActionsPerMinute, Apm, ECsvCustomStatOp::Set);
+        CSV_CUSTOM_STAT(Tetris, FinesseFaults, static_cast<int32>(FaultCount), ECsvCustomStatOp::Set);
+        CSV_CUSTOM_STAT(Tetris, Lines, static_cast<int32>(LineCount), ECsvCustomStatOp::Set);
+        CSV_CUSTOM_STAT(Tetris, Attack, static_cast<int32>(AttackCount), ECsvCustomStatOp::Set);
+        CSV_CUSTOM_STAT(Tetris, InputToLockP99Us, static_cast<float>(Latency.P99), ECsvCustomStatOp::Set);
+        return;
+    }
+
+    FString Text;
+    if (Sink == ETetrisTelemetrySink::Json)
+    {
+        Text = FString::Printf(
+            TEXT("{\"game\":\"%s\",\"seconds\":%.3f,\"pieces\":%llu,\"pps\":%.3f,\"apm\":%.2f,\"finesse_faults\":%llu,\"lines\":%llu,\"attack\":%llu,")
+            TEXT("\"placement_us\":{\"mean\":%.1f,\"p50\":%llu,\"p90\":%llu,\"p99\":%llu,\"max\":%llu},")
+            TEXT("\"input_to_lock_us\":{\"mean\":%.1f,\"p50\":%llu,\"p90\":%llu,\"p99\":%llu,\"max\":%llu}}\n"),
+            *GameId, Seconds, PieceCount, Pps, Apm, FaultCount, LineCount, AttackCount,
+            Placement.Mean, Placement.P50, Placement.P90, Placement.P99, Placement.Max,
+            Latency.Mean, Latency.P50, Latency.P90, Latency.P99, Latency.Max);
+    }
+    else
+    {
+        if (!bWroteCsvHeader)
+        {
+            bWroteCsvHeader = true;
+            Text = TEXT("seconds,pieces,pps,apm,finesse_faults,lines,attack,")
+                TEXT("placement_mean_us,placement_p50_us,placement_p90_us,placement_p99_us,placement_max_us,")
+                TEXT("input_to_lock_mean_us,input_to_lock_p50_us,input_to_lock_p90_us,input_to_lock_p99_us,input_to_lock_max_us\n");
+        }
+        Text += FString::Printf(
+            TEXT("%.3f,%llu,%.3f,%.2f,%llu,%llu,%llu,%.1f,%llu,%llu,%llu,%llu,%.1f,%llu,%llu,%llu,%llu\n"),
+            Seconds, PieceCount, Pps, Apm, FaultCount, LineCount, AttackCount,
+            Placement.Mean, Placement.P50, Placement.P90, Placement.P99, Placement.Max,
+            Latency.Mean, Latency.P50, Latency.P90, Latency.P99, Latency.Max);
+    }
+
+    // File IO off the game thread
+    TetrisTelemetry::QueueAppend(OutputPath, MoveTemp(Text));
+}
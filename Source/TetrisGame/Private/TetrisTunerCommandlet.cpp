@@ -0,0 +1,109 @@
+#include "TetrisTunerCommandlet.h"
+#include "TetrisBotWeights.h"
+#include "TetrisWeightTuner.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "UObject/Package.h"
+#include "UObject/SavePackage.h"
+
+namespace TetrisTunerCommandlet
+{
+    static bool SaveWeightsAsset(const FString& PackageName, const FTetrisWeightTuner& Tuner, const FTetrisTunerConfig& Config)
+    {
+#if WITH_EDITOR
+        if (!FPackageName::IsValidLongPackageName(PackageName))
+        {
+            UE_LOG(LogTemp, Error, TEXT("TetrisTunerCommandlet - Invalid output package %s"), *PackageName);
+            return false;
+        }
+
+        UPackage* Package = CreatePackage(*PackageName);
+        Package->FullyLoad();
+
+        const FString AssetName = FPackageName::GetLongPackageAssetName(PackageName);
+        UTetrisBotWeights* Asset = FindObject<UTetrisBotWeights>(Package, *AssetName);
+        if (!Asset)
+        {
+            Asset = NewObject<UTetrisBotWeights>(Package, *AssetName, RF_Public | RF_Standalone);
+        }
+
+        Asset->Weights = Tuner.GetBestWeights();
+        Asset->Generation = Tuner.GetGeneration();
+        Asset->Fitness = static_cast<float>(Tuner.GetBestFitness());
+        Asset->GamesPerCandidate = Config.GamesPerCandidate;
+        Asset->MaxPiecesPerGame = Config.Sim.MaxPieces;
+        Asset->MarkPackageDirty();
+
+        const FString Filename = FPackageName::LongPackageNameToFilename(PackageName, FPackageName::GetAssetPackageExtension());
+        FSavePackageArgs SaveArgs;
+        SaveArgs.TopLevelFlags = RF_Public | RF_Standalone;
+        SaveArgs.SaveFlags = SAVE_NoError;
+        if (!UPackage::SavePackage(Package, Asset, *Filename, SaveArgs))
+        {
+            UE_LOG(LogTemp, Error, TEXT("TetrisTunerCommandlet - Failed to save %s"), *Filename);
+            return false;
+        }
+        return true;
+#else
+        UE_LOG(LogTemp, Error, TEXT("TetrisTunerCommandlet - Saving assets needs an editor build"));
+        return false;
+#endif
+    }
+}
+
+UTetrisTunerCommandlet::UTetrisTunerCommandlet()
+{
+    IsClient = false;
+    IsEditor = true;
+    IsServer = false;
+    LogToConsole = true;
+}
+
+int32 UTetrisTunerCommandlet::Main(const FString& Params)
+{
+    FTetrisTunerConfig Config;
+    int32 Generations = 50;
+    FParse::Value(*Params, TEXT("Generations="), Generations);
+    FParse::Value(*Params, TEXT("Population="), Config.PopulationSize);
+    FParse::Value(*Params, TEXT("Games="), Config.GamesPerCandidate);
+    FParse::Value(*Params, TEXT("Pieces="), Config.Sim.MaxPieces);
+    FParse::Value(*Params, TEXT("Seed="), Config.Seed);
+
+    FString CheckpointPath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Tuner"), TEXT("TetrisTuner.ckpt"));
+    FParse::Value(*Params, TEXT("Checkpoint="), CheckpointPath);
+
+    FString OutputPackage = TEXT("/Game/AI/DA_TetrisBotWeights");
+    FParse::Value(*Params, TEXT("Output="), OutputPackage);
+
+    FTetrisWeightTuner Tuner(Config);
+    if (!FParse::Param(*Params, TEXT("Fresh")) && Tuner.LoadCheckpoint(CheckpointPath))
+    {
+        UE_LOG(LogTemp, Display, TEXT("TetrisTunerCommandlet - Resuming from %s at generation %d (best %.1f)"),
+            *CheckpointPath, Tuner.GetGeneration(), Tuner.GetBestFitness());
+    }
+
+    const double Start = FPlatformTime::Seconds();
+    const int64 StartGames = Tuner.GetTotalGames();
+    while (Tuner.GetGeneration() < Generations)
+    {
+        Tuner.RunGeneration();
+        Tuner.SaveCheckpoint(CheckpointPath);
+
+        UE_LOG(LogTemp, Display, TEXT("TetrisTunerCommandlet - Generation %d/%d: best %.1f, %.1f games/s/core"),
+            Tuner.GetGeneration(), Generations, Tuner.GetBestFitness(), Tuner.GetLastGamesPerSecondPerCore());
+    }
+
+    const double Elapsed = FPlatformTime::Seconds() - Start;
+    const int64 Games = Tuner.GetTotalGames() - StartGames;
+    if (Games > 0)
+    {
+        UE_LOG(LogTemp, Display, TEXT("TetrisTunerCommandlet - %lld games in %.1fs, %.1f games/s/core on %d cores"),
+            Games, Elapsed, Games / FMath::Max(Elapsed, 1e-6) / FMath::Max(FPlatformMisc::NumberOfCores(), 1), FPlatformMisc::NumberOfCores());
+    }
+
+    const FTetrisPlacementWeights Best = Tuner.GetBestWeights();
+    UE_LOG(LogTemp, Display, TEXT("TetrisTunerCommandlet - Best weights: height %.4f, max %.4f, bump %.4f, holes %.4f, rowT %.4f, colT %.4f, wells %.4f, lines %.4f"),
+        Best.AggregateHeight, Best.MaxHeight, Best.Bumpiness, Best.Holes, Best.RowTransitions, Best.ColumnTransitions, Best.WellDepthSum, Best.CompleteLines);
+
+    return TetrisTunerCommandlet::SaveWeightsAsset(OutputPackage, Tuner, Config) ? 0 : 1;
+}
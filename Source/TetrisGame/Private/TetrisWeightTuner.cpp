@@ -0,0 +1,304 @@
+#include "TetrisWeightTuner.h"
+#include "Async/ParallelFor.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace TetrisWeightTuner
+{
+    static constexpr uint32 CheckpointMagic = 0x4E555454; // "TTUN"
+    static constexpr int32 CheckpointVersion = 1;
+}
+
+FTetrisWeightTuner::FTetrisWeightTuner(const FTetrisTunerConfig& InConfig)
+    : Config(InConfig)
+    , Random(InConfig.Seed)
+{
+    Config.PopulationSize = FMath::Max(Config.PopulationSize, 2);
+    Config.GamesPerCandidate = FMath::Max(Config.GamesPerCandidate, 1);
+    Config.EliteCount = FMath::Clamp(Config.EliteCount, 0, Config.PopulationSize - 1);
+    Config.TournamentSize = FMath::Max(Config.TournamentSize, 1);
+
+    for (int32 Game = 0; Game < Config.GamesPerCandidate; ++Game)
+    {
+        GameSeeds.Add(Random.RandHelper(MAX_int32));
+    }
+
+    // Start from the hand-picked defaults plus random directions
+    Population.SetNum(Config.PopulationSize);
+    FromWeights(FTetrisPlacementWeights(), Population[0].Genes);
+    for (int32 Index = 1; Index < Population.Num(); ++Index)
+    {
+        for (float& Gene : Population[Index].Genes)
+        {
+            Gene = Random.FRandRange(-1.f, 1.f);
+        }
+    }
+    for (FCandidate& Candidate : Population)
+    {
+        Normalize(Candidate.Genes);
+    }
+}
+
+FTetrisPlacementWeights FTetrisWeightTuner::ToWeights(const float (&Genes)[NumWeights])
+{
+    FTetrisPlacementWeights Weights;
+    Weights.AggregateHeight = Genes[0];
+    Weights.MaxHeight = Genes[1];
+    Weights.Bumpiness = Genes[2];
+    Weights.Holes = Genes[3];
+    Weights.RowTransitions = Genes[4];
+    Weights.ColumnTransitions = Genes[5];
+    Weights.WellDepthSum = Genes[6];
+    Weights.CompleteLines = Genes[7];
+    return Weights;
+}
+
+void FTetrisWeightTuner::FromWeights(const FTetrisPlacementWeights& Weights, float (&OutGenes)[NumWeights])
+{
+    OutGenes[0] = Weights.AggregateHeight;
+    OutGenes[1] = Weights.MaxHeight;
+    OutGenes[2] = Weights.Bumpiness;
+    OutGenes[3] = Weights.Holes;
+    OutGenes[4] = Weights.RowTransitions;
+    OutGenes[5] = Weights.ColumnTransitions;
+    OutGenes[6] = Weights.WellDepthSum;
+    OutGenes[7] = Weights.CompleteLines;
+}
+
+void FTetrisWeightTuner::Normalize(float (&Genes)[NumWeights])
+{
+    float LengthSquared = 0.f;
+    for (float Gene : Genes)
+    {
+        LengthSquared += Gene * Gene;
+    }
+    if (LengthSquared > SMALL_NUMBER)
+    {
+        const float Scale = FMath::InvSqrt(LengthSquared);
+        for (float& Gene : Genes)
+        {
+            Gene *= Scale;
+        }
+    }
+}
+
+void FTetrisWeightTuner::RunGeneration()
+{
+    EvaluatePopulation();
+    ++Generation;
+    Breed();
+}
+
+void FTetrisWeightTuner::EvaluatePopulation()
+{
+    TArray<int32> Pending;
+    for (int32 Index = 0; Index < Population.Num(); ++Index)
+    {
+        if (!Population[Index].bEvaluated)
+        {
+            Pending.Add(Index);
+        }
+    }
+
+    const int32 GamesPerCandidate = GameSeeds.Num();
+    const int32 NumGames = Pending.Num() * GamesPerCandidate;
+    TArray<int64> Scores;
+    Scores.SetNumZeroed(NumGames);
+
+    // One task per game rather than per candidate keeps every core busy when games end early
+    const double Start = FPlatformTime::Seconds();
+    ParallelFor(NumGames, [&](int32 Index)
+    {
+        const FCandidate& Candidate = Population[Pending[Index / GamesPerCandidate]];
+        Scores[Index] = TetrisSimulation::PlayGame(ToWeights(Candidate.Genes), GameSeeds[Index % GamesPerCandidate], Config.Sim).Score;
+    });
+    const double Elapsed = FPlatformTime::Seconds() - Start;
+
+    for (int32 PendingIndex = 0; PendingIndex < Pending.Num(); ++PendingIndex)
+    {
+        int64 Total = 0;
+        for (int32 Game = 0; Game < GamesPerCandidate; ++Game)
+        {
+            Total += Scores[PendingIndex * GamesPerCandidate + Game];
+        }
+
+        FCandidate& Candidate = Population[Pending[PendingIndex]];
+        Candidate.Fitness = double(Total) / GamesPerCandidate;
+        Candidate.bEvaluated = true;
+        if (Candidate.Fitness > BestFitness)
+        {
+            BestFitness = Candidate.Fitness;
+            FMemory::Memcpy(BestGenes, Candidate.Genes, sizeof(BestGenes));
+        }
+    }
+
+    TotalGames += NumGames;
+    LastGamesPerSecondPerCore = NumGames / FMath::Max(Elapsed, 1e-6) / FMath::Max(FPlatformMisc::NumberOfCores(), 1);
+}
+
+const FTetrisWeightTuner::FCandidate& FTetrisWeightTuner::Tournament()
+{
+    const FCandidate* Winner = &Population[Random.RandRange(0, Population.Num() - 1)];
+    for (int32 Round = 1; Round < Config.TournamentSize; ++Round)
+    {
+        const FCandidate& Challenger = Population[Random.RandRange(0, Population.Num() - 1)];
+        if (Challenger.Fitness > Winner->Fitness)
+        {
+            Winner = &Challenger;
+        }
+    }
+    return *Winner;
+}
+
+void FTetrisWeightTuner::Breed()
+{
+    Population.Sort([](const FCandidate& A, const FCandidate& B) { return A.Fitness > B.Fitness; });
+
+    TArray<FCandidate> Next;
+    Next.Reserve(Population.Num());
+    for (int32 Index = 0; Index < Config.EliteCount; ++Index)
+    {
+        Next.Add(Population[Index]);
+    }
+
+    while (Next.Num() < Population.Num())
+    {
+        const FCandidate& A = Tournament();
+        const FCandidate& B = Tournament();
+
+        // Fitness-weighted average of the parents, so the child leans towards the stronger one
+        const double WeightA = A.Fitness + 1.0;
+        const double WeightB = B.Fitness + 1.0;
+        FCandidate& Child = Next.AddDefaulted_GetRef();
+        for (int32 Gene = 0; Gene < NumWeights; ++Gene)
+        {
+            Child.Genes[Gene] = static_cast<float>(A.Genes[Gene] * WeightA + B.Genes[Gene] * WeightB);
+        }
+        Normalize(Child.Genes);
+
+        if (Random.FRand() < Config.MutationRate)
+        {
+            Child.Genes[Random.RandRange(0, NumWeights - 1)] += Random.FRandRange(-Config.MutationStep, Config.MutationStep);
+            Normalize(Child.Genes);
+        }
+    }
+
+    Population = MoveTemp(Next);
+}
+
+bool FTetrisWeightTuner::SaveCheckpoint(const FString& Path) const
+{
+    TArray<uint8> Bytes;
+    FMemoryWriter Ar(Bytes);
+
+    uint32 Magic = TetrisWeightTuner::CheckpointMagic;
+    int32 Version = TetrisWeightTuner::CheckpointVersion;
+    FTetrisTunerConfig SavedConfig = Config;
+    int32 RandomSeed = Random.GetCurrentSeed();
+    int32 SavedGeneration = Generation;
+    double SavedBestFitness = BestFitness;
+    int64 SavedTotalGames = TotalGames;
+    int32 NumCandidates = Population.Num();
+
+    Ar << Magic << Version;
+    Ar << SavedConfig.PopulationSize << SavedConfig.GamesPerCandidate << SavedConfig.Seed;
+    Ar << SavedConfig.Sim.Width << SavedConfig.Sim.Height << SavedConfig.Sim.MaxPieces;
+    Ar << RandomSeed << SavedGeneration << SavedBestFitness << SavedTotalGames;
+    for (float Gene : BestGenes)
+    {
+        Ar << Gene;
+    }
+
+    Ar << NumCandidates;
+    for (FCandidate Candidate : Population)
+    {
+        for (float& Gene : Candidate.Genes)
+        {
+            Ar << Gene;
+        }
+        Ar << Candidate.Fitness << Candidate.bEvaluated;
+    }
+
+    // Write beside the old checkpoint and swap, so a kill mid-write leaves the previous one intact
+    const FString TempPath = Path + TEXT(".tmp");
+    if (!FFileHelper::SaveArrayToFile(Bytes, *TempPath) || !IFileManager::Get().Move(*Path, *TempPath, true, true))
+    {
+        UE_LOG(LogTemp, Error, TEXT("TetrisWeightTuner::SaveCheckpoint - Failed to write %s"), *Path);
+        return false;
+    }
+    return true;
+}
+
+bool FTetrisWeightTuner::LoadCheckpoint(const FString& Path)
+{
+    TArray<uint8> Bytes;
+    if (!FFileHelper::LoadFileToArray(Bytes, *Path, FILEREAD_Silent))
+    {
+        return false;
+    }
+
+    FMemoryReader Ar(Bytes);
+    uint32 Magic = 0;
+    int32 Version = 0;
+    Ar << Magic << Version;
+    if (Magic != TetrisWeightTuner::CheckpointMagic || Version != TetrisWeightTuner::CheckpointVersion)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("TetrisWeightTuner::LoadCheckpoint - %s is not a version %d checkpoint"), *Path, TetrisWeightTuner::CheckpointVersion);
+        return false;
+    }
+
+    FTetrisTunerConfig Saved;
+    Ar << Saved.PopulationSize << Saved.GamesPerCandidate << Saved.Seed;
+    Ar << Saved.Sim.Width << Saved.Sim.Height << Saved.Sim.MaxPieces;
+    if (Saved.PopulationSize != Config.PopulationSize || Saved.GamesPerCandidate != Config.GamesPerCandidate || Saved.Seed != Config.Seed
+        || Saved.Sim.Width != Config.Sim.Width || Saved.Sim.Height != Config.Sim.Height || Saved.Sim.MaxPieces != Config.Sim.MaxPieces)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("TetrisWeightTuner::LoadCheckpoint - %s was made with different settings, starting over"), *Path);
+        return false;
+    }
+
+    int32 RandomSeed = 0;
+    int32 LoadedGeneration = 0;
+    double LoadedBestFitness = 0.0;
+    int64 LoadedTotalGames = 0;
+    float LoadedBestGenes[NumWeights];
+    Ar << RandomSeed << LoadedGeneration << LoadedBestFitness << LoadedTotalGames;
+    for (float& Gene : LoadedBestGenes)
+    {
+        Ar << Gene;
+    }
+
+    int32 NumCandidates = 0;
+    Ar << NumCandidates;
+    if (NumCandidates != Config.PopulationSize)
+    {
+        return false;
+    }
+
+    TArray<FCandidate> LoadedPopulation;
+    LoadedPopulation.SetNum(NumCandidates);
+    for (FCandidate& Candidate : LoadedPopulation)
+    {
+        for (float& Gene : Candidate.Genes)
+        {
+            Ar << Gene;
+        }
+        Ar << Candidate.Fitness << Candidate.bEvaluated;
+    }
+
+    if (Ar.IsError())
+    {
+        UE_LOG(LogTemp, Warning, TEXT("TetrisWeightTuner::LoadCheckpoint - %s is truncated"), *Path);
+        return false;
+    }
+
+    Random.Initialize(RandomSeed);
+    Generation = LoadedGeneration;
+    BestFitness = LoadedBestFitness;
+    TotalGames = LoadedTotalGames;
+    FMemory::Memcpy(BestGenes, LoadedBestGenes, sizeof(BestGenes));
+    Population = MoveTemp(LoadedPopulation);
+    return true;
+}
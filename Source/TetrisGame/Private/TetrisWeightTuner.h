@@ -0,0 +1,77 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Math/RandomStream.h"
+#include "TetrisSimulation.h"
+
+struct FTetrisTunerConfig
+{
+    int32 PopulationSize = 64;
+    int32 GamesPerCandidate = 8;
+    // Best candidates copied unchanged into the next generation
+    int32 EliteCount = 4;
+    int32 TournamentSize = 4;
+    // Chance that a child gets one weight nudged by up to +-MutationStep
+    float MutationRate = 0.15f;
+    float MutationStep = 0.2f;
+    // Seeds both the genetic algorithm and the fixed piece sequences every candidate plays
+    int32 Seed = 1;
+    FTetrisSimConfig Sim;
+};
+
+/*
+ * Genetic search over FTetrisPlacementWeights. Every candidate plays the same seeded games,
+ * so fitness differences come from the weights rather than the piece sequence. All
+ * (candidate, game) pairs of a generation run in one ParallelFor; elites keep their
+ * fitness and are not replayed. The whole state fits in a small checkpoint file.
+ */
+class FTetrisWeightTuner
+{
+public:
+    static constexpr int32 NumWeights = 8;
+
+    explicit FTetrisWeightTuner(const FTetrisTunerConfig& InConfig);
+
+    // Evaluate the current population and breed the next one
+    void RunGeneration();
+
+    // Restore a previous run; false if the file is missing, unreadable or was made with a different config
+    bool LoadCheckpoint(const FString& Path);
+    bool SaveCheckpoint(const FString& Path) const;
+
+    int32 GetGeneration() const { return Generation; }
+    FTetrisPlacementWeights GetBestWeights() const { return ToWeights(BestGenes); }
+    double GetBestFitness() const { return BestFitness; }
+    int64 GetTotalGames() const { return TotalGames; }
+
+    // Throughput of the last RunGeneration
+    double GetLastGamesPerSecondPerCore() const { return LastGamesPerSecondPerCore; }
+
+private:
+    struct FCandidate
+    {
+        float Genes[NumWeights] = {};
+        double Fitness = 0.0;
+        bool bEvaluated = false;
+    };
+
+    static FTetrisPlacementWeights ToWeights(const float (&Genes)[NumWeights]);
+    static void FromWeights(const FTetrisPlacementWeights& Weights, float (&OutGenes)[NumWeights]);
+    // Scale to unit length; only the direction of the weight vector changes which placement wins
+    static void Normalize(float (&Genes)[NumWeights]);
+
+    void EvaluatePopulation();
+    const FCandidate& Tournament();
+    void Breed();
+
+    FTetrisTunerConfig Config;
+    FRandomStream Random;
+    TArray<int32> GameSeeds;
+    TArray<FCandidate> Population;
+
+    int32 Generation = 0;
+    float BestGenes[NumWeights] = {};
+    double BestFitness = -1.0;
+    int64 TotalGames = 0;
+    double LastGamesPerSecondPerCore = 0.0;
+};
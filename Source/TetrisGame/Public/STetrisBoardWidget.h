@@ -0,0 +1,89 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Widgets/SLeafWidget.h"
+
+class ATetrisBoard;
+
+/*
+ * Draws a whole board (locked cells, active piece, ghost and preview queue) in one OnPaint.
+ * Horizontal runs of cells are merged into single boxes on one layer so they batch together.
+ * The widget never ticks; it only invalidates paint when the board revision changes, which
+ * lets global invalidation or a retainer box cache it between changes.
+ */
+class TETRISGAME_API STetrisBoardWidget : public SLeafWidget
+{
+public:
+    struct FPalette
+    {
+        FLinearColor Background = FLinearColor(0.02f, 0.02f, 0.03f, 1.f);
+        FLinearColor Locked = FLinearColor(0.55f, 0.6f, 0.7f, 1.f);
+        FLinearColor Active = FLinearColor(0.2f, 0.8f, 1.f, 1.f);
+        FLinearColor Ghost = FLinearColor(0.2f, 0.8f, 1.f, 0.25f);
+        FLinearColor Preview = FLinearColor(0.9f, 0.9f, 0.9f, 1.f);
+    };
+
+    SLATE_BEGIN_ARGS(STetrisBoardWidget)
+        : _Board(nullptr)
+        , _DesiredCellSize(16.f)
+        , _PreviewColumns(4)
+    {}
+        // Board to draw
+        SLATE_ARGUMENT(ATetrisBoard*, Board)
+        // Cell size used for the desired size
+        SLATE_ARGUMENT(float, DesiredCellSize)
+        // Width (in cells) reserved for the preview queue, 0 hides it
+        SLATE_ARGUMENT(int32, PreviewColumns)
+        SLATE_ARGUMENT(FPalette, Palette)
+    SLATE_END_ARGS()
+
+    STetrisBoardWidget();
+    virtual ~STetrisBoardWidget();
+
+    void Construct(const FArguments& InArgs);
+
+    void SetBoard(ATetrisBoard* InBoard);
+    void SetPalette(const FPalette& InPalette);
+    void SetDesiredCellSize(float InCellSize);
+    void SetPreviewColumns(int32 InPreviewColumns);
+
+    // SWidget interface
+    virtual int32 OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect,
+        FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const override;
+    virtual FVector2D ComputeDesiredSize(float LayoutScaleMultiplier) const override;
+
+private:
+    // Horizontal run of cells in board space (Y = 0 is the bottom row)
+    struct FCellRun
+    {
+        int32 X;
+        int32 Y;
+        int32 Length;
+    };
+
+    void HandleBoardRevisionChanged(uint32 Revision);
+    void UnbindBoard();
+
+    // Rebuild the run lists if the board changed since the last paint
+    void UpdateCache() const;
+
+    // Merge a set of cells into runs, dropping anything outside the visible rows
+    static void BuildRuns(TArray<FIntPoint>& Cells, int32 ClipWidth, int32 ClipHeight, TArray<FCellRun>& OutRuns);
+
+    TWeakObjectPtr<ATetrisBoard> Board;
+    FDelegateHandle RevisionHandle;
+
+    FPalette Palette;
+    float DesiredCellSize;
+    int32 PreviewColumns;
+
+    // Paint cache, rebuilt only when the board revision moves
+    mutable uint32 CachedRevision = MAX_uint32;
+    mutable int32 CachedWidth = 0;
+    mutable int32 CachedHeight = 0;
+    mutable TArray<FCellRun> LockedRuns;
+    mutable TArray<FCellRun> ActiveRuns;
+    mutable TArray<FCellRun> GhostRuns;
+    mutable TArray<FCellRun> PreviewRuns;
+    mutable TArray<FIntPoint> ScratchCells;
+};
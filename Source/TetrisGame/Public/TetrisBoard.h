@@ -2,9 +2,15 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "TetrisBoardGrid.h"
+#include "TetrisSnapshotRing.h"
+#include "TetrisBoardJournal.h"
+#include "TetrisSolver.h"
 #include "TetrisBoard.generated.h"
 
 class ATetrisPiece;
+class ULineBatchComponent;
+class UInstancedStaticMeshComponent;
 
 /*
  * Coordinate system:
@@ -18,6 +24,12 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnNewPieceSpawnedSignature, ATetris
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnLinesClearedSignature, int32, LinesCleared, int32, NewScore);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnGameOverSignature);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnPieceMovementFailedSignature, FVector, AttemptedPosition);
+DECLARE_DYNAMIC_DELEGATE_ThreeParams(FOnPuzzleSolvedSignature, bool, bSolved, const TArray<FTetrisSolution>&, Solutions, bool, bTimedOut);
+
+// Native (non-dynamic) so Slate widgets can bind without a UObject
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnBoardRevisionChangedSignature, uint32 /*Revision*/);
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnRowsClearedSignature, int32 /*RowsCleared*/);
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnRowsChangedSignature, int32 /*MinRow*/, int32 /*MaxRow*/);
 
 UCLASS()
 class TETRISGAME_API ATetrisBoard : public AActor
@@ -44,6 +56,11 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Tetris Board")
 	int32 ClearLines();
 
+	// Push garbage rows in from the bottom, leaving HoleColumn open (-1 for a random column).
+	// Returns false (and broadcasts game over) if blocks were pushed off the top.
+	UFUNCTION(BlueprintCallable, Category = "Tetris Board")
+	bool AddGarbageRows(int32 Count, int32 HoleColumn = -1);
+
 	// Attempt to move piece with validation
 	UFUNCTION(BlueprintCallable, Category = "Tetris Board")
 	bool TryMovePiece(ATetrisPiece* Piece, FVector Direction);
@@ -87,6 +104,88 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Tetris Board")
 	void DrawDebugGrid();
 
+	// Revision counter, bumped whenever the grid or the active piece changes
+	UFUNCTION(BlueprintPure, Category = "Tetris Board")
+	int32 GetBoardRevision() const { return static_cast<int32>(BoardRevision); }
+
+	// Bump the revision and notify views (call after moving/rotating a piece outside the board)
+	UFUNCTION(BlueprintCallable, Category = "Tetris Board")
+	void MarkBoardDirty();
+
+	// Check if a grid cell holds a locked block
+	UFUNCTION(BlueprintPure, Category = "Tetris Board")
+	bool IsCellOccupied(int32 X, int32 Y) const;
+
+	// Grid cells covered by a piece's blocks
+	UFUNCTION(BlueprintCallable, Category = "Tetris Board")
+	bool GetPieceCells(ATetrisPiece* Piece, TArray<FIntPoint>& OutCells) const;
+
+	// Grid cells the current piece would occupy after a hard drop
+	UFUNCTION(BlueprintCallable, Category = "Tetris Board")
+	bool GetGhostCells(TArray<FIntPoint>& OutCells) const;
+
+	// Upcoming piece types, nearest first; draw them from their default object's GetPreviewCells
+	UFUNCTION(BlueprintCallable, Category = "Tetris Board")
+	void GetPreviewQueue(TArray<TSubclassOf<ATetrisPiece>>& OutQueue) const;
+
+	/** Called whenever the board revision changes */
+	FOnBoardRevisionChangedSignature OnBoardRevisionChanged;
+
+	/** Called whenever full rows are removed, whether by a lock or by ClearLines */
+	FOnRowsClearedSignature OnRowsCleared;
+
+	/** Called when locked cells in rows [MinRow, MaxRow] may have changed; piece movement never fires it */
+	FOnRowsChangedSignature OnRowsChanged;
+
+	// Packed occupancy rows
+	const FTetrisBoardGrid& GetGrid() const { return Grid; }
+
+	// Go back to before the previous piece was placed and respawn it
+	UFUNCTION(BlueprintCallable, Category = "Tetris Board|Practice")
+	bool Undo();
+
+	// Return to the piece an Undo left
+	UFUNCTION(BlueprintCallable, Category = "Tetris Board|Practice")
+	bool Redo();
+
+	// Restore the board as it was when piece PieceNumber spawned (see GetPieceNumber)
+	UFUNCTION(BlueprintCallable, Category = "Tetris Board|Practice")
+	bool RewindToPiece(int32 PieceNumber);
+
+	UFUNCTION(BlueprintPure, Category = "Tetris Board|Practice")
+	bool CanUndo() const { return UndoHistory.CanStepBack(); }
+
+	UFUNCTION(BlueprintPure, Category = "Tetris Board|Practice")
+	bool CanRedo() const { return UndoHistory.CanStepForward(); }
+
+	// Number of the current piece, counting from 0 since Initialize
+	UFUNCTION(BlueprintPure, Category = "Tetris Board|Practice")
+	int32 GetPieceNumber() const { return NextPieceNumber - 1; }
+
+	// Search for ways to place Queue on the current locked blocks (the falling piece is ignored).
+	// LinesToClear is the goal for ClearLines, or the height of the clear for PerfectClear (0 = lowest possible).
+	// Returns false if nothing was found; check bTimedOut to tell "unsolvable" from "out of time".
+	// Blocks the calling thread for up to TimeBudgetSeconds, so it is for editor tools and tests;
+	// gameplay should use SolvePuzzleAsync.
+	UFUNCTION(BlueprintCallable, Category = "Tetris Board|Practice")
+	bool SolvePuzzle(const TArray<ETetrisPieceShape>& Queue, ETetrisSolverGoal Goal, int32 LinesToClear, bool bFindAll,
+		float TimeBudgetSeconds, TArray<FTetrisSolution>& OutSolutions, bool& bTimedOut) const;
+
+	// SolvePuzzle on a background thread against the board as it is now. OnSolved runs on the
+	// game thread when the search ends. Returns false, without calling OnSolved, if the board can't be searched.
+	UFUNCTION(BlueprintCallable, Category = "Tetris Board|Practice")
+	bool SolvePuzzleAsync(const TArray<ETetrisPieceShape>& Queue, ETetrisSolverGoal Goal, int32 LinesToClear, bool bFindAll,
+		float TimeBudgetSeconds, FOnPuzzleSolvedSignature OnSolved) const;
+
+	// Rebuild the board from its journal after a restart; call instead of Initialize + SpawnNewPiece.
+	// Returns false, leaving the board alone, when there is no usable journal or its game already ended.
+	UFUNCTION(BlueprintCallable, Category = "Tetris Board|Journal")
+	bool ResumeFromJournal();
+
+	// Recreate the locked block instances from the grid in one batch
+	UFUNCTION(BlueprintCallable, Category = "Tetris Board")
+	void RebuildLockedBlockVisuals();
+
 public:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Tetris Board")
 	int32 CurrentScore = 0;
@@ -95,12 +194,38 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tetris Board")
 	float CellSize = 100.f;
 
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Tetris Board")
+	// Board dimensions in cells, applied on Initialize
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Tetris Board", meta = (ClampMin = "1", ClampMax = "1024"))
 	int32 Width;
 
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Tetris Board")
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Tetris Board", meta = (ClampMin = "1", ClampMax = "65535"))
 	int32 Height;
 
+	// Draw the debug grid on Initialize
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tetris Board")
+	bool bDrawDebugGrid = true;
+
+	// Placements kept for undo (applied on Initialize), 0 disables history.
+	// Needs a LockedBlocks mesh, since locked piece actors can't be restored.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Tetris Board|Practice", meta = (ClampMin = "0"))
+	int32 UndoHistoryLimit = 4096;
+
+	// Journal every placement so a restarted server can resume the match
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Tetris Board|Journal")
+	bool bEnableJournal = false;
+
+	// File name under Saved/Journal, the actor name when empty
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Tetris Board|Journal", meta = (EditCondition = "bEnableJournal"))
+	FString JournalName;
+
+	// Pieces between packed board checkpoints, which bounds how much a resume replays
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Tetris Board|Journal", meta = (EditCondition = "bEnableJournal", ClampMin = "1"))
+	int32 JournalCheckpointInterval = 64;
+
+	// Longest time between fsyncs of the journal
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Tetris Board|Journal", meta = (EditCondition = "bEnableJournal", ClampMin = "0.0"))
+	float JournalSyncInterval = 0.25f;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tetris Board")
 	ATetrisPiece* CurrentPiece = nullptr;
 
@@ -128,6 +253,15 @@ protected:
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
     USceneComponent* BottomBoundary;
 
+    // Batched debug grid lines
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+    ULineBatchComponent* DebugGridLines;
+
+    // Locked blocks, drawn from the grid. With a mesh assigned, locked piece actors are
+    // destroyed and these instances are the only visuals, which is what lets undo restore them.
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+    UInstancedStaticMeshComponent* LockedBlocks;
+
     // Spawner class to use
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tetris Board")
     TSubclassOf<class ATetrisPieceSpawner> SpawnerClass;
@@ -139,6 +273,58 @@ protected:
     UPROPERTY()
     bool bIsInitialized = false;
 
-	// 2D array representing occupied board cells
-	TArray<TArray<bool>> Grid;
+	// Packed, chunked occupancy rows
+	FTetrisBoardGrid Grid;
+
+	// Clear full rows in [MinRow, MaxRow], returns the number cleared
+	int32 ClearCompletedRows(int32 MinRow, int32 MaxRow);
+
+	// Journal the end of the match and broadcast OnGameOver
+	void EndGame();
+
+	// Rules kernel picked for the current dimensions on Initialize
+	const struct FTetrisBoardKernelOps* Kernel = nullptr;
+
+	// Convert a world location to grid coordinates
+	FIntPoint WorldToCell(const FVector& Location) const;
+
+	// Inverse of WorldToCell, at the board's depth
+	FVector CellToWorld(const FIntPoint& Cell) const;
+
+	uint32 BoardRevision = 0;
+
+	// Spawn the next piece, optionally recording an undo snapshot first
+	void SpawnPiece(bool bRecordSnapshot);
+
+	void RestoreSnapshot(const FTetrisBoardSnapshot& Snapshot);
+
+	// Solver request for the locked blocks; false if the board can't be searched
+	bool MakeSolverRequest(const TArray<ETetrisPieceShape>& Queue, ETetrisSolverGoal Goal, int32 LinesToClear, bool bFindAll,
+		float TimeBudgetSeconds, FTetrisSolverRequest& OutRequest) const;
+
+	bool HasLockedBlockVisuals() const;
+
+	// Add or remove instances for the cells in [MinRow, MaxRow] whose occupancy changed since
+	// they were last drawn; cells that stay filled keep their instance, even across a clear
+	void UpdateLockedBlockVisuals(int32 MinRow, int32 MaxRow);
+
+	// Occupancy the instances currently show, packed like the grid
+	TArray<uint64> DrawnRows;
+	// Instance of each drawn cell (Y * Width + X), and the reverse
+	TMap<int32, int32> CellInstances;
+	TArray<int32> InstanceCells;
+
+	FTetrisSnapshotRing UndoHistory;
+
+	int32 NextPieceNumber = 0;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	FString GetJournalPath() const;
+
+	FTetrisBoardJournal Journal;
+	int32 PiecesSinceCheckpoint = 0;
+	// Set when the journal must restart from a checkpoint at the next spawn
+	bool bJournalCheckpointDue = false;
+	bool bResumingFromJournal = false;
 };
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "TetrisBoardEval.generated.h"
+
+class ATetrisBoard;
+
+/*
+ * Heuristic features of a board, as used by placement scorers.
+ * Rows are packed one uint64 per row (bit X = column X, row 0 at the bottom), Width <= 64.
+ */
+USTRUCT(BlueprintType)
+struct TETRISGAME_API FTetrisBoardFeatures
+{
+    GENERATED_BODY()
+
+    // Sum of column heights
+    UPROPERTY(BlueprintReadOnly, Category = "Tetris Eval")
+    int32 AggregateHeight = 0;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Tetris Eval")
+    int32 MaxHeight = 0;
+
+    // Sum of height differences between neighbouring columns
+    UPROPERTY(BlueprintReadOnly, Category = "Tetris Eval")
+    int32 Bumpiness = 0;
+
+    // Empty cells with a block somewhere above them
+    UPROPERTY(BlueprintReadOnly, Category = "Tetris Eval")
+    int32 Holes = 0;
+
+    // Filled/empty changes along each row up to the stack top (walls count as filled)
+    UPROPERTY(BlueprintReadOnly, Category = "Tetris Eval")
+    int32 RowTransitions = 0;
+
+    // Filled/empty changes down each column (floor counts as filled)
+    UPROPERTY(BlueprintReadOnly, Category = "Tetris Eval")
+    int32 ColumnTransitions = 0;
+
+    // Sum of well depths: open cells whose left and right neighbours are both filled
+    UPROPERTY(BlueprintReadOnly, Category = "Tetris Eval")
+    int32 WellDepthSum = 0;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Tetris Eval")
+    int32 CompleteLines = 0;
+
+    bool operator==(const FTetrisBoardFeatures& Other) const
+    {
+        return AggregateHeight == Other.AggregateHeight && MaxHeight == Other.MaxHeight && Bumpiness == Other.Bumpiness
+            && Holes == Other.Holes && RowTransitions == Other.RowTransitions && ColumnTransitions == Other.ColumnTransitions
+            && WellDepthSum == Other.WellDepthSum && CompleteLines == Other.CompleteLines;
+    }
+};
+
+// Linear weights applied to FTetrisBoardFeatures by the placement scorer
+USTRUCT(BlueprintType)
+struct TETRISGAME_API FTetrisPlacementWeights
+{
+    GENERATED_BODY()
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tetris Eval")
+    float AggregateHeight = -0.510066f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tetris Eval")
+    float MaxHeight = 0.f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tetris Eval")
+    float Bumpiness = -0.184483f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tetris Eval")
+    float Holes = -0.35663f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tetris Eval")
+    float RowTransitions = 0.f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tetris Eval")
+    float ColumnTransitions = 0.f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tetris Eval")
+    float WellDepthSum = 0.f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tetris Eval")
+    float CompleteLines = 0.760666f;
+};
+
+enum class ETetrisSimdLevel : uint8
+{
+    Scalar,
+    // SSSE3 + SSE4.1, two boards per pass
+    SSE4,
+    // Four boards per pass
+    AVX2,
+};
+
+namespace TetrisBoardEval
+{
+    // Best instruction set supported by this CPU (checked once at runtime)
+    TETRISGAME_API ETetrisSimdLevel GetSupportedSimdLevel();
+
+    TETRISGAME_API const TCHAR* LexToString(ETetrisSimdLevel Level);
+
+    // Features of one board
+    TETRISGAME_API FTetrisBoardFeatures EvaluateBoard(const uint64* Rows, int32 Width, int32 Height);
+
+    // Features of NumBoards boards sharing one geometry. Board B's rows start at Rows + B * Height.
+    // Level is clamped to what the CPU supports.
+    TETRISGAME_API void EvaluateBoards(const uint64* Rows, int32 NumBoards, int32 Width, int32 Height,
+        FTetrisBoardFeatures* OutFeatures, ETetrisSimdLevel Level = ETetrisSimdLevel::AVX2);
+
+    TETRISGAME_API float Score(const FTetrisBoardFeatures& Features, const FTetrisPlacementWeights& Weights);
+
+    // Index of the best-scoring board in a batch, INDEX_NONE if empty
+    TETRISGAME_API int32 PickBestPlacement(const uint64* Rows, int32 NumBoards, int32 Width, int32 Height,
+        const FTetrisPlacementWeights& Weights, TArray<FTetrisBoardFeatures>& ScratchFeatures);
+}
+
+// Blueprint access for debugging overlays
+UCLASS()
+class TETRISGAME_API UTetrisBoardEvalLibrary : public UBlueprintFunctionLibrary
+{
+    GENERATED_BODY()
+
+public:
+    // Heuristic features of the board's current grid (boards wider than 64 columns are not supported)
+    UFUNCTION(BlueprintCallable, Category = "Tetris Eval")
+    static FTetrisBoardFeatures EvaluateTetrisBoard(ATetrisBoard* Board);
+
+    UFUNCTION(BlueprintCallable, Category = "Tetris Eval")
+    static void GetColumnHeights(ATetrisBoard* Board, TArray<int32>& OutHeights);
+
+    UFUNCTION(BlueprintPure, Category = "Tetris Eval")
+    static float ScoreFeatures(const FTetrisBoardFeatures& Features, const FTetrisPlacementWeights& Weights);
+};
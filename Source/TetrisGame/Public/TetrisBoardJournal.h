@@ -0,0 +1,98 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "TetrisSnapshotRing.h"
+
+class FEvent;
+class FRunnableThread;
+class IFileHandle;
+
+/*
+ * Record layout: uint32 PayloadSize, uint32 Crc (CRC32 of Type and payload), uint8 Type, payload.
+ * A journal file always starts with a Checkpoint; replay stops at the first torn or corrupt record.
+ * A GameOver record ends the match, so a journal holding one has nothing left to resume.
+ */
+enum class ETetrisJournalRecord : uint8
+{
+    // State before a piece spawns: int32 Width, Height, Score, PieceNumber, spawner state, then the packed rows
+    Checkpoint,
+    // int32 PieceNumber, spawner state before the spawn
+    PieceSpawned,
+    // int32 PieceNumber, spawner state after the lock, uint8 Count, Count x (int16 X, int16 Y)
+    PieceLocked,
+    // int32 LinesCleared, int32 NewScore
+    LinesCleared,
+    // int32 Count, int32 HoleColumn
+    Garbage,
+    // int32 FinalScore
+    GameOver,
+};
+
+/*
+ * Write-ahead journal for one board, so a restarted server can resume a match.
+ *
+ * The game thread only encodes records into a pending buffer. A worker thread writes the buffer
+ * out every BatchInterval (so a process crash loses at most that much) and fsyncs at most once
+ * per SyncInterval (the window an OS crash can lose). A checkpoint starts a new file: it is
+ * written beside the old one, synced and then swapped in, so the journal stays one checkpoint
+ * plus a short tail and replay is bounded by the checkpoint interval.
+ */
+class TETRISGAME_API FTetrisBoardJournal : public FRunnable
+{
+public:
+    FTetrisBoardJournal();
+    virtual ~FTetrisBoardJournal();
+
+    // Start the writer. The file is left alone until the first checkpoint replaces it.
+    bool Open(const FString& InPath, float InBatchInterval = 0.01f, float InSyncInterval = 0.25f);
+
+    // Write out and sync everything pending, then stop the writer
+    void Close();
+
+    bool IsOpen() const { return Thread != nullptr; }
+
+    void WriteCheckpoint(const FTetrisBoardSnapshot& State);
+    void WritePieceSpawned(int32 PieceNumber, const FTetrisSpawnerState& SpawnerState);
+    void WritePieceLocked(int32 PieceNumber, const FTetrisSpawnerState& SpawnerState, TConstArrayView<FIntPoint> Cells);
+    void WriteLinesCleared(int32 LinesCleared, int32 NewScore);
+    void WriteGarbage(int32 Count, int32 HoleColumn);
+    void WriteGameOver(int32 FinalScore);
+
+    // Rebuild the last consistent state from a journal file. OutState.PieceNumber is the next piece to spawn.
+    // Returns false for a journal without a checkpoint or one whose game has already ended.
+    static bool Replay(const FString& Path, FTetrisBoardSnapshot& OutState);
+
+    // FRunnable interface
+    virtual uint32 Run() override;
+    virtual void Stop() override;
+
+private:
+    // Frame Scratch as a record and queue it
+    void Submit(ETetrisJournalRecord Type);
+
+    // Writer thread: drain the pending buffer to disk
+    void WritePending(bool bForceSync);
+
+    FString Path;
+    float BatchInterval = 0.01f;
+    float SyncInterval = 0.25f;
+
+    FRunnableThread* Thread = nullptr;
+    FEvent* WakeEvent = nullptr;
+    std::atomic<bool> bStopping{ false };
+
+    // Game thread encode buffer
+    TArray<uint8> Scratch;
+
+    FCriticalSection PendingLock;
+    TArray<uint8> Pending;
+    // Start of the newest checkpoint in Pending; anything before it is superseded
+    int32 PendingCheckpointOffset = INDEX_NONE;
+
+    // Writer thread only
+    TArray<uint8> Writing;
+    TUniquePtr<IFileHandle> File;
+    double LastSyncTime = 0.0;
+    bool bUnsynced = false;
+};
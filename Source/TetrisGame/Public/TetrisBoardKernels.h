@@ -0,0 +1,57 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TetrisBoardGrid.h"
+
+/*
+ * Rules kernels used by ATetrisBoard for placement checks and line clears.
+ *
+ * TTetrisBoardKernel bakes the board geometry into the type, so the row mask, full-line
+ * constant and loop bounds are compile-time constants the compiler can unroll and vectorize.
+ * It is explicitly instantiated for the standard sizes below; every other size goes through
+ * the generic kernel, which reads the geometry from the grid at runtime.
+ */
+struct FTetrisBoardKernelOps
+{
+    // Index of the first cell that is out of bounds or overlaps a block, INDEX_NONE if the placement fits.
+    // Cells above the top row are allowed as long as they are within the side walls.
+    int32 (*FindCollision)(const FTetrisBoardGrid& Grid, const FIntPoint* Cells, int32 NumCells);
+
+    // Remove every full row in [MinRow, MaxRow], returns the number removed
+    int32 (*ClearFullRows)(FTetrisBoardGrid& Grid, int32 MinRow, int32 MaxRow);
+
+    const TCHAR* Name;
+};
+
+template <int32 InWidth, int32 InHeight>
+struct TTetrisBoardKernel
+{
+    static_assert(InWidth > 0 && InWidth <= 64, "Specialized kernels use one word per row");
+    static_assert(InHeight > 0 && InHeight <= FTetrisBoardGrid::ChunkRows, "Specialized kernels need a single-chunk grid");
+
+    static constexpr int32 Width = InWidth;
+    static constexpr int32 Height = InHeight;
+    static constexpr uint64 FullRowMask = InWidth == 64 ? ~uint64(0) : (uint64(1) << InWidth) - 1;
+
+    static int32 FindCollision(const FTetrisBoardGrid& Grid, const FIntPoint* Cells, int32 NumCells);
+    static int32 ClearFullRows(FTetrisBoardGrid& Grid, int32 MinRow, int32 MaxRow);
+};
+
+struct FTetrisGenericBoardKernel
+{
+    static int32 FindCollision(const FTetrisBoardGrid& Grid, const FIntPoint* Cells, int32 NumCells);
+    static int32 ClearFullRows(FTetrisBoardGrid& Grid, int32 MinRow, int32 MaxRow);
+};
+
+extern template struct TTetrisBoardKernel<10, 20>;
+extern template struct TTetrisBoardKernel<10, 40>;
+extern template struct TTetrisBoardKernel<4, 20>;
+extern template struct TTetrisBoardKernel<6, 20>;
+
+namespace TetrisBoardKernels
+{
+    // Specialized kernel for this geometry if one exists, otherwise the generic one
+    TETRISGAME_API const FTetrisBoardKernelOps& Select(int32 Width, int32 Height);
+
+    TETRISGAME_API const FTetrisBoardKernelOps& Generic();
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/Widget.h"
+#include "TetrisBoardWidget.generated.h"
+
+class ATetrisBoard;
+class STetrisBoardWidget;
+
+// UMG wrapper around STetrisBoardWidget. Wrap in a RetainerBox to render many boards at a reduced rate.
+UCLASS()
+class TETRISGAME_API UTetrisBoardWidget : public UWidget
+{
+	GENERATED_BODY()
+
+public:
+	// Set the board to draw
+	UFUNCTION(BlueprintCallable, Category = "Tetris Board Widget")
+	void SetBoard(ATetrisBoard* InBoard);
+
+	UFUNCTION(BlueprintCallable, Category = "Tetris Board Widget")
+	ATetrisBoard* GetBoard() const { return Board; }
+
+	// UWidget interface
+	virtual void SynchronizeProperties() override;
+	virtual void ReleaseSlateResources(bool bReleaseChildren) override;
+
+#if WITH_EDITOR
+	virtual const FText GetPaletteCategory() override;
+#endif
+
+protected:
+	virtual TSharedRef<SWidget> RebuildWidget() override;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Tetris Board Widget")
+	TObjectPtr<ATetrisBoard> Board;
+
+	// Cell size used for the desired size
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Tetris Board Widget", meta = (ClampMin = "1"))
+	float DesiredCellSize = 16.f;
+
+	// Width (in cells) reserved for the preview queue, 0 hides it
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Tetris Board Widget", meta = (ClampMin = "0"))
+	int32 PreviewColumns = 4;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Appearance")
+	FLinearColor BackgroundColor = FLinearColor(0.02f, 0.02f, 0.03f, 1.f);
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Appearance")
+	FLinearColor LockedColor = FLinearColor(0.55f, 0.6f, 0.7f, 1.f);
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Appearance")
+	FLinearColor ActiveColor = FLinearColor(0.2f, 0.8f, 1.f, 1.f);
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Appearance")
+	FLinearColor GhostColor = FLinearColor(0.2f, 0.8f, 1.f, 0.25f);
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Appearance")
+	FLinearColor PreviewColor = FLinearColor(0.9f, 0.9f, 0.9f, 1.f);
+
+private:
+	TSharedPtr<STetrisBoardWidget> MyBoardWidget;
+};
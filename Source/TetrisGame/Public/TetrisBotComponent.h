@@ -0,0 +1,56 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "TetrisBoardEval.h"
+#include "TetrisSimulation.h"
+#include "TetrisBotComponent.generated.h"
+
+class ATetrisBoard;
+class ATetrisPiece;
+class UTetrisBotWeights;
+
+/*
+ * Plays the owning board: for each spawned piece it samples the piece's four rotations,
+ * picks a placement with the headless simulator and then drives the real piece there
+ * through the board API. Weights come from a tuned UTetrisBotWeights asset when set.
+ */
+UCLASS(ClassGroup = (Tetris), meta = (BlueprintSpawnableComponent))
+class TETRISGAME_API UTetrisBotComponent : public UActorComponent
+{
+    GENERATED_BODY()
+
+public:
+    UTetrisBotComponent();
+
+    // Place the current piece now
+    UFUNCTION(BlueprintCallable, Category = "Tetris Bot")
+    void PlayCurrentPiece();
+
+protected:
+    virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+    // Tuned weights; the defaults in FTetrisPlacementWeights are used when unset
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Tetris Bot")
+    TSoftObjectPtr<UTetrisBotWeights> WeightsAsset;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tetris Bot")
+    bool bEnabled = true;
+
+    // Seconds between a piece spawning and the bot placing it
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tetris Bot", meta = (ClampMin = "0"))
+    float PlacementDelay = 0.25f;
+
+private:
+    UFUNCTION()
+    void HandleNewPieceSpawned(ATetrisPiece* NewPiece);
+
+    UPROPERTY()
+    ATetrisBoard* Board = nullptr;
+
+    FTetrisPlacementWeights Weights;
+    FTetrisSimBoard SimBoard;
+    FTetrisSimScratch Scratch;
+    FTimerHandle PlacementTimerHandle;
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "TetrisBoardEval.h"
+#include "TetrisBotWeights.generated.h"
+
+/*
+ * Placement weights for UTetrisBotComponent. Written by the TetrisTuner commandlet;
+ * the tuning fields record where the weights came from and are informational only.
+ */
+UCLASS(BlueprintType)
+class TETRISGAME_API UTetrisBotWeights : public UPrimaryDataAsset
+{
+    GENERATED_BODY()
+
+public:
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Tetris Bot")
+    FTetrisPlacementWeights Weights;
+
+    // Generations the tuner had completed when these weights were written
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Tuning")
+    int32 Generation = 0;
+
+    // Mean game score of these weights over the tuning seeds
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Tuning")
+    float Fitness = 0.f;
+
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Tuning")
+    int32 GamesPerCandidate = 0;
+
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Tuning")
+    int32 MaxPiecesPerGame = 0;
+};
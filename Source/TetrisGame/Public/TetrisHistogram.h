@@ -0,0 +1,87 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+/*
+ * Fixed-bucket, lock-free histogram.
+ * Log-linear buckets: values below SubBuckets get a bucket each, and every power of two above
+ * that is split into SubBuckets equal ranges, so a bucket is never wider than 1/SubBuckets of
+ * its values (9 ms and 15 ms land in different buckets). Values of 2^32 and up share the last
+ * bucket. Recording is a couple of relaxed atomic adds and never allocates, so it is safe on
+ * the game thread hot path and from any thread.
+ */
+class TETRISGAME_API FTetrisHistogram
+{
+public:
+    static constexpr int32 SubBucketBits = 3;
+    static constexpr int32 SubBuckets = 1 << SubBucketBits;
+    static constexpr int32 NumBuckets = SubBuckets + (32 - SubBucketBits) * SubBuckets;
+
+    struct FSummary
+    {
+        uint64 Count = 0;
+        uint64 Sum = 0;
+        uint64 Max = 0;
+        double Mean = 0.0;
+        uint64 P50 = 0;
+        uint64 P90 = 0;
+        uint64 P99 = 0;
+    };
+
+    FTetrisHistogram() { Reset(); }
+
+    void Record(uint64 Value)
+    {
+        Buckets[BucketFor(Value)].fetch_add(1, std::memory_order_relaxed);
+        Count.fetch_add(1, std::memory_order_relaxed);
+        Sum.fetch_add(Value, std::memory_order_relaxed);
+
+        uint64 Previous = Max.load(std::memory_order_relaxed);
+        while (Value > Previous && !Max.compare_exchange_weak(Previous, Value, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    void Reset()
+    {
+        for (std::atomic<uint64>& Bucket : Buckets)
+        {
+            Bucket.store(0, std::memory_order_relaxed);
+        }
+        Count.store(0, std::memory_order_relaxed);
+        Sum.store(0, std::memory_order_relaxed);
+        Max.store(0, std::memory_order_relaxed);
+    }
+
+    // Percentiles are reported as the upper bound of the bucket they fall in
+    FSummary Summarize() const;
+
+    static int32 BucketFor(uint64 Value)
+    {
+        if (Value < SubBuckets)
+        {
+            return static_cast<int32>(Value);
+        }
+        // The top SubBucketBits + 1 bits pick the bucket: the leading one gives the power of two
+        const int32 Shift = 63 - static_cast<int32>(FMath::CountLeadingZeros64(Value)) - SubBucketBits;
+        const int32 Bucket = (Shift + 1) * SubBuckets + static_cast<int32>((Value >> Shift) & (SubBuckets - 1));
+        return FMath::Min(Bucket, NumBuckets - 1);
+    }
+
+    static uint64 BucketUpperBound(int32 Bucket)
+    {
+        if (Bucket < SubBuckets)
+        {
+            return Bucket;
+        }
+        const int32 Shift = Bucket / SubBuckets - 1;
+        return ((uint64(SubBuckets + Bucket % SubBuckets) + 1) << Shift) - 1;
+    }
+
+private:
+    std::atomic<uint64> Buckets[NumBuckets];
+    std::atomic<uint64> Count;
+    std::atomic<uint64> Sum;
+    std::atomic<uint64> Max;
+};
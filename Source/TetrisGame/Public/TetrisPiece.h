@@ -34,4 +34,14 @@ public:
     // Size of each block in the piece
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tetris Piece")
     float BlockSize;
+
+    // Cell layout (relative to the piece origin) used to draw this piece in preview UI.
+    // Leave empty to derive it from the Blocks layout (see GetPreviewCells).
+    UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Tetris Piece")
+    TArray<FIntPoint> PreviewCells;
+
+    // PreviewCells, or the Blocks relative locations in BlockSize units when none were authored.
+    // Meant to be called on the class default object.
+    UFUNCTION(BlueprintCallable, Category = "Tetris Piece")
+    void GetPreviewCells(TArray<FIntPoint>& OutCells) const;
 };
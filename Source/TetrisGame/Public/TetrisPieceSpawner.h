@@ -2,11 +2,19 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "Math/RandomStream.h"
 #include "TetrisPieceSpawner.generated.h"
 
 class ATetrisPiece;
 class ATetrisBoard;
 
+// Everything that decides which pieces come next, for snapshots
+struct FTetrisSpawnerState
+{
+    int32 RandomSeed = 0;
+    TSubclassOf<ATetrisPiece> NextPieceType;
+};
+
 UCLASS()
 class TETRISGAME_API ATetrisPieceSpawner : public AActor
 {
@@ -27,6 +35,9 @@ public:
     UFUNCTION(BlueprintCallable, Category = "Tetris")
     void SetBoardReference(ATetrisBoard* InBoard);
 
+    FTetrisSpawnerState GetState() const;
+    void RestoreState(const FTetrisSpawnerState& State);
+
 protected:
     // Array of all possible piece types
     UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Tetris")
@@ -36,6 +47,12 @@ protected:
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Tetris")
     TSubclassOf<ATetrisPiece> NextPieceType;
 
+    // Seed for the piece sequence, 0 picks one at BeginPlay
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Tetris")
+    int32 RandomSeed = 0;
+
+    virtual void BeginPlay() override;
+
 public:
     // Reference to the game board for positioning
     // Visual representation of spawn point
@@ -44,7 +61,9 @@ public:
 
 private:
     // Select a random piece type
-    TSubclassOf<ATetrisPiece> GetRandomPieceType() const;
+    TSubclassOf<ATetrisPiece> GetRandomPieceType();
+
+    FRandomStream Random;
 
     UPROPERTY()
     ATetrisBoard* Board;
@@ -6,6 +6,7 @@
 
 class ATetrisPiece;
 class ATetrisBoard;
+class UTetrisTelemetryComponent;
 
 UCLASS()
 class TETRISGAME_API ATetrisPlayerController : public APlayerController
@@ -61,4 +62,8 @@ private:
 	UPROPERTY()
 	ATetrisBoard* GameBoard;
 
+	// Telemetry on the game board, if it has one
+	UPROPERTY()
+	UTetrisTelemetryComponent* Telemetry;
+
 };
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "TetrisPuzzleCommandlet.generated.h"
+
+/*
+ * Bulk validation of puzzle files against the solver:
+ *
+ *   UnrealEditor-Cmd <Project>.uproject -run=TetrisPuzzle -unattended -nullrhi
+ *       [-Puzzles=<dir>] [-Serial]
+ *
+ * Without -Puzzles it runs the plugin's Resources/Puzzles, whose expected answers were checked
+ * against an unpruned brute-force search. Every *.txt file in the directory is one puzzle:
+ *
+ *   # Comment
+ *   queue: TILJ
+ *   goal: pc              (or "pc 4" for a fixed height, or "lines 2")
+ *   budget: 5             (seconds, default 10)
+ *   expect: solvable      (or "unsolvable", or "count 12" to enumerate every solution)
+ *   height: 20            (optional, at least the number of board rows)
+ *   ....XXXXXX
+ *   ....XXXXXX            (board rows, top first, '.' empty and 'X' filled)
+ *
+ * Returns non-zero if any puzzle does not match its expectation, including when a search
+ * runs out of time before it can prove a puzzle unsolvable.
+ */
+UCLASS()
+class TETRISGAME_API UTetrisPuzzleCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+public:
+    UTetrisPuzzleCommandlet();
+
+    virtual int32 Main(const FString& Params) override;
+};
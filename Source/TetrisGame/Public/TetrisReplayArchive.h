@@ -0,0 +1,243 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "Templates/SharedPointer.h"
+
+class IFileHandle;
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+// What the index knows about an archived game
+struct FTetrisReplayInfo
+{
+    uint64 GameId = 0;
+    uint64 PlayerId = 0;
+    int64 Score = 0;
+    // Unix time the game ended
+    int64 EndTime = 0;
+};
+
+/*
+ * On-disk layout. All integers are little-endian.
+ *
+ * Segment file (Seg_<id>.trs): FSegmentHeader, then records back to back. Each record is a
+ * length-prefixed FRecordHeader followed by the zlib-compressed replay (spectator stream frames).
+ * Segments are only ever appended to, and become read-only once sealed.
+ *
+ * Index file (Seg_<id>.tri), written when a segment is sealed: FIndexHeader, NumEntries
+ * FIndexEntry sorted by game ID, then two permutations of that table as uint32 indices, one
+ * sorted by player (best score first) and one by score (best first). Readers map it and search
+ * it in place.
+ *
+ * Manifest (Archive.manifest): the sealed segments that make up the archive. It is replaced
+ * atomically, so readers and compaction always see a consistent set.
+ *
+ * Lease (Archive.lock): the process ID of the writer that has the directory open.
+ */
+namespace TetrisReplayArchive
+{
+    constexpr uint32 SegmentMagic = 0x53505254; // "TRPS"
+    constexpr uint32 IndexMagic = 0x49505254; // "TRPI"
+    constexpr uint32 ManifestMagic = 0x4D505254; // "TRPM"
+    constexpr uint32 FormatVersion = 1;
+
+    struct FSegmentHeader
+    {
+        uint32 Magic = SegmentMagic;
+        uint32 Version = FormatVersion;
+        uint64 SegmentId = 0;
+    };
+
+    struct FRecordHeader
+    {
+        // Bytes that follow this field: the rest of the header plus the compressed payload
+        uint32 RecordSize = 0;
+        // CRC32 of the compressed payload
+        uint32 PayloadCrc = 0;
+        uint64 GameId = 0;
+        uint64 PlayerId = 0;
+        int64 Score = 0;
+        int64 EndTime = 0;
+        uint32 UncompressedSize = 0;
+        uint32 CompressedSize = 0;
+    };
+
+    struct FIndexHeader
+    {
+        uint32 Magic = IndexMagic;
+        uint32 Version = FormatVersion;
+        uint32 NumEntries = 0;
+        uint32 Reserved = 0;
+    };
+
+    struct FIndexEntry
+    {
+        uint64 GameId = 0;
+        uint64 PlayerId = 0;
+        int64 Score = 0;
+        // Offset of the record header in the segment
+        uint64 Offset = 0;
+    };
+
+    static_assert(sizeof(FRecordHeader) == 48, "Record header layout is part of the file format");
+    static_assert(sizeof(FIndexEntry) == 32, "Index entry layout is part of the file format");
+
+    TETRISGAME_API FString GetSegmentPath(const FString& Directory, uint64 SegmentId);
+    TETRISGAME_API FString GetIndexPath(const FString& Directory, uint64 SegmentId);
+    TETRISGAME_API FString GetManifestPath(const FString& Directory);
+    TETRISGAME_API FString GetLeasePath(const FString& Directory);
+}
+
+/*
+ * Writer side of an archive directory. Append is thread-safe and only touches the active
+ * segment; sealing and compaction take the manifest lock just long enough to swap it, so a
+ * compaction running on another thread never stalls games being written.
+ *
+ * A segment left unsealed by a crash is indexed up to its last intact record on the next Open.
+ * Only sealed segments are visible to readers, so a segment is also sealed once it has been open
+ * for SealSeconds; the shared archive checks that on a timer, so a quiet server still publishes
+ * a finished game within minutes. Compaction merges the small segments this produces. One writing process per directory, enforced by
+ * the lease file: Open fails while another live process holds it. Any number of readers.
+ * Compaction belongs to the writer, so a running server compacts with Tetris.CompactReplays.
+ */
+class TETRISGAME_API FTetrisReplayArchive
+{
+public:
+    // Segments are sealed once they pass this size, or have been open this long
+    static constexpr int64 DefaultSegmentBytes = 256ll * 1024 * 1024;
+    static constexpr double DefaultSealSeconds = 300.0;
+
+    ~FTetrisReplayArchive();
+
+    // Shared writer for a directory, so every recorder in the process appends to the same active segment
+    static TSharedPtr<FTetrisReplayArchive, ESPMode::ThreadSafe> GetShared(const FString& Directory);
+
+    bool Open(const FString& InDirectory, int64 InSegmentBytes = DefaultSegmentBytes, double InSealSeconds = DefaultSealSeconds);
+    void Close();
+
+    bool Append(const FTetrisReplayInfo& Info, const TArray<uint8>& Replay);
+
+    // Flush the active segment to disk
+    void Flush();
+
+    // Index the active segment and publish it to readers; the next Append starts a new one
+    bool SealActiveSegment();
+
+    // Seal the active segment if it has been open for SealSeconds
+    bool SealIfDue();
+
+    // Merge sealed segments smaller than TargetSegmentBytes into one, dropping older copies of
+    // re-archived games. Safe to call from any thread while appends continue.
+    // Returns the number of segments merged.
+    int32 Compact(int64 TargetSegmentBytes = 4 * DefaultSegmentBytes);
+
+    const FString& GetDirectory() const { return Directory; }
+
+private:
+    struct FManifest
+    {
+        uint64 NextSegmentId = 1;
+        TArray<uint64> Segments;
+        // Segment the writer is appending to, 0 if none
+        uint64 OpenSegment = 0;
+    };
+
+    bool SaveManifest() const;
+
+    // Index a finished segment file and add it to the manifest
+    bool PublishSegment(uint64 SegmentId, TArray<TetrisReplayArchive::FIndexEntry>& Entries);
+
+    // Delete segment files the manifest no longer references
+    void DeleteUnreferencedSegments(const TArray<uint64>& Candidates);
+
+    FString Directory;
+    int64 SegmentBytes = DefaultSegmentBytes;
+    double SealSeconds = DefaultSealSeconds;
+    // Shared archives only: periodic SealIfDue
+    FTSTicker::FDelegateHandle SealTicker;
+    // Set while this instance holds the directory's writer lease
+    bool bHoldsWriterLease = false;
+
+    // Guards the active segment
+    FCriticalSection WriterLock;
+    TUniquePtr<IFileHandle> ActiveFile;
+    uint64 ActiveSegmentId = 0;
+    int64 ActiveBytes = 0;
+    double ActiveStartTime = 0.0;
+    TArray<TetrisReplayArchive::FIndexEntry> ActiveEntries;
+    TArray<uint8> CompressScratch;
+
+    // Guards Manifest and segment id allocation; never held while doing file I/O on records
+    mutable FCriticalSection ManifestLock;
+    FManifest Manifest;
+
+    // Only one compaction at a time
+    FCriticalSection CompactionLock;
+};
+
+/*
+ * Read side. Maps every sealed segment and its index when opened, so lookups are binary searches
+ * over mapped memory and a record is decompressed straight out of the mapping. Reflects the
+ * manifest at the time of Open; reopen to see newer segments. If a compaction deletes segments
+ * between reading the manifest and mapping them, Open reads the new manifest and tries again.
+ */
+class TETRISGAME_API FTetrisReplayArchiveReader
+{
+public:
+    FTetrisReplayArchiveReader();
+    ~FTetrisReplayArchiveReader();
+
+    bool Open(const FString& Directory);
+    void Close();
+
+    int64 GetNumGames() const;
+
+    // Newest archived copy of a game; OutReplay may be null to fetch only the info
+    bool FindGame(uint64 GameId, FTetrisReplayInfo& OutInfo, TArray<uint8>* OutReplay = nullptr) const;
+
+    // Best scores first
+    void GetTopScores(int32 Count, TArray<FTetrisReplayInfo>& OutGames) const;
+    void GetPlayerGames(uint64 PlayerId, int32 MaxGames, TArray<FTetrisReplayInfo>& OutGames) const;
+
+private:
+    struct FMappedSegment
+    {
+        uint64 SegmentId = 0;
+        TUniquePtr<IMappedFileHandle> SegmentHandle;
+        TUniquePtr<IMappedFileRegion> SegmentRegion;
+        TUniquePtr<IMappedFileHandle> IndexHandle;
+        TUniquePtr<IMappedFileRegion> IndexRegion;
+
+        const TetrisReplayArchive::FIndexEntry* Entries = nullptr;
+        const uint32* ByPlayer = nullptr;
+        const uint32* ByScore = nullptr;
+        uint32 NumEntries = 0;
+    };
+
+    // One segment's entries in score order: Order[Next..End) indexes Entries
+    struct FScoreCursor
+    {
+        int32 SegmentIndex = 0;
+        const TetrisReplayArchive::FIndexEntry* Entries = nullptr;
+        const uint32* Order = nullptr;
+        int32 Next = 0;
+        int32 End = 0;
+
+        const TetrisReplayArchive::FIndexEntry* Entry() const { return &Entries[Order[Next]]; }
+    };
+
+    // Map a segment and its index, null if either is missing or the index is malformed
+    static TUniquePtr<FMappedSegment> MapSegment(const FString& Directory, uint64 SegmentId);
+
+    bool ReadRecord(const FMappedSegment& Segment, uint64 Offset, FTetrisReplayInfo& OutInfo, TArray<uint8>* OutReplay) const;
+
+    // True if no segment newer than Segments[SegmentIndex] holds the game
+    bool IsNewestCopy(int32 SegmentIndex, uint64 GameId) const;
+
+    // Best Count games across the cursors, counting only the newest copy of each
+    void MergeByScore(TArray<FScoreCursor>& Cursors, int32 Count, TArray<FTetrisReplayInfo>& OutGames) const;
+
+    // Newest segment first, so the first hit for a game ID is its latest copy
+    TArray<TUniquePtr<FMappedSegment>> Segments;
+};
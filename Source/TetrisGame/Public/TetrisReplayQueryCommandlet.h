@@ -0,0 +1,27 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "TetrisReplayQueryCommandlet.generated.h"
+
+/*
+ * Replay archive queries and maintenance:
+ *
+ *   UnrealEditor-Cmd <Project>.uproject -run=TetrisReplayQuery -unattended -nullrhi
+ *       -Archive=<dir> [-Top=N] [-Player=<id> [-Max=N]] [-Game=<id> [-Export=<file>]] [-Compact]
+ *
+ * -Top lists the best scores, -Player a player's best games and -Game one game, whose
+ * decompressed stream is written to -Export when given. -Compact merges small sealed segments
+ * first, and only when no server is writing the archive (use Tetris.CompactReplays in the
+ * server instead). Lookups only touch the mapped indexes and the records they point at.
+ */
+UCLASS()
+class TETRISGAME_API UTetrisReplayQueryCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+public:
+    UTetrisReplayQueryCommandlet();
+
+    virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "TetrisSpectatorStream.h"
+#include "TetrisReplayRecorder.generated.h"
+
+class ATetrisBoard;
+class FTetrisReplayArchive;
+class UTetrisSpectatorPublisher;
+
+/*
+ * Records the owning board's spectator stream and appends each finished game to a replay
+ * archive. Needs a UTetrisSpectatorPublisher on the same actor; the recorded bytes are its
+ * frames, starting with a snapshot, so they play back with any spectator client.
+ */
+UCLASS(ClassGroup = (Tetris), meta = (BlueprintSpawnableComponent))
+class TETRISGAME_API UTetrisReplayRecorder : public UActorComponent
+{
+    GENERATED_BODY()
+
+public:
+    UTetrisReplayRecorder();
+
+    virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+    // ID the current game will be archived under
+    UFUNCTION(BlueprintPure, Category = "Tetris Replay")
+    int64 GetGameId() const { return static_cast<int64>(GameId); }
+
+    // Player the archived games are indexed under
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tetris Replay")
+    int64 PlayerId = 0;
+
+protected:
+    virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+    // Archive directory, Saved/Replays when empty
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Tetris Replay")
+    FString ArchiveDirectory;
+
+    // How often to drain the stream; must be well inside what the publisher's ring holds
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Tetris Replay", meta = (ClampMin = "0.0"))
+    float PollInterval = 0.25f;
+
+private:
+    UFUNCTION()
+    void HandleGameOver();
+
+    void Poll();
+
+    // Archive what was recorded (off the game thread) and start a new game
+    void FinishGame();
+
+    void StartGame();
+
+    UPROPERTY()
+    TObjectPtr<ATetrisBoard> Board;
+
+    UPROPERTY()
+    TObjectPtr<UTetrisSpectatorPublisher> Publisher;
+
+    TSharedPtr<FTetrisReplayArchive, ESPMode::ThreadSafe> Archive;
+
+    FTetrisSpectatorCursor Cursor;
+    TArray<uint8> Recording;
+    uint64 GameId = 0;
+};
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TetrisBoardEval.h"
+
+/*
+ * Headless board simulation for bots and offline tuning: no actors, no world, one uint64 per
+ * row (Width <= 64). Pieces are dropped straight down from above the stack, and every
+ * reachable (rotation, column) pair is scored in one batched TetrisBoardEval call.
+ */
+
+// One orientation of a piece, normalized so its cells touch X = 0 and Y = 0
+struct FTetrisSimRotation
+{
+    static constexpr int32 MaxExtent = 4;
+
+    // Occupied columns per piece row, row 0 at the bottom
+    uint64 RowBits[MaxExtent] = {};
+
+    // Lowest occupied row in each piece column (MaxExtent for an empty column)
+    int32 ColumnBottom[MaxExtent] = {};
+
+    int32 Width = 0;
+    int32 Height = 0;
+};
+
+// The distinct orientations of a piece
+struct TETRISGAME_API FTetrisSimShape
+{
+    TArray<FTetrisSimRotation, TInlineAllocator<4>> Rotations;
+
+    // Add an orientation given as absolute cells. Returns its rotation index (an existing one if
+    // it duplicates an earlier orientation), or INDEX_NONE if the piece is wider or taller than MaxExtent.
+    int32 AddRotation(const FIntPoint* Cells, int32 NumCells);
+};
+
+struct FTetrisSimPlacement
+{
+    int32 Rotation = INDEX_NONE;
+    // Board column and row of the rotation's bottom-left corner
+    int32 X = 0;
+    int32 Y = 0;
+
+    bool IsValid() const { return Rotation != INDEX_NONE; }
+};
+
+class TETRISGAME_API FTetrisSimBoard
+{
+public:
+    void Init(int32 InWidth, int32 InHeight);
+
+    // Replace the contents with Height packed rows
+    void SetRows(const uint64* InRows);
+
+    int32 GetWidth() const { return Width; }
+    int32 GetHeight() const { return Height; }
+    const uint64* GetRows() const { return Rows.GetData(); }
+
+    // Row the rotation comes to rest on when dropped at column X, INDEX_NONE if it would stick out of the top
+    int32 FindLandingRow(const FTetrisSimRotation& Rotation, int32 X) const;
+
+    // Lock a piece and clear full rows, returns the number of rows cleared
+    int32 Place(const FTetrisSimRotation& Rotation, int32 X, int32 Y);
+
+    static void Stamp(uint64* InRows, const FTetrisSimRotation& Rotation, int32 X, int32 Y);
+
+private:
+    void UpdateColumnHeights();
+
+    int32 Width = 0;
+    int32 Height = 0;
+    uint64 RowMask = 0;
+    TArray<uint64> Rows;
+    TArray<int32> ColumnHeights;
+};
+
+// Reusable buffers for placement searches, one per thread
+struct FTetrisSimScratch
+{
+    TArray<uint64> CandidateRows;
+    TArray<FTetrisSimPlacement> Placements;
+    TArray<FTetrisBoardFeatures> Features;
+};
+
+struct FTetrisSimConfig
+{
+    int32 Width = 10;
+    int32 Height = 20;
+    // Games end here if the bot has not topped out
+    int32 MaxPieces = 500;
+};
+
+struct FTetrisSimGameResult
+{
+    int32 Pieces = 0;
+    int32 Lines = 0;
+    // Same rule as ATetrisBoard::ClearLines: lines squared times 100 per clear
+    int64 Score = 0;
+    bool bToppedOut = false;
+};
+
+namespace TetrisSimulation
+{
+    // I, O, T, S, Z, J, L
+    TETRISGAME_API const TArray<FTetrisSimShape>& GetStandardShapes();
+
+    // Highest-scoring placement of Shape on Board, invalid if none fits
+    TETRISGAME_API FTetrisSimPlacement FindBestPlacement(const FTetrisSimBoard& Board, const FTetrisSimShape& Shape,
+        const FTetrisPlacementWeights& Weights, FTetrisSimScratch& Scratch);
+
+    // Play one game with a 7-bag piece sequence drawn from Seed. Deterministic for a given seed and weights.
+    TETRISGAME_API FTetrisSimGameResult PlayGame(const FTetrisPlacementWeights& Weights, int32 Seed, const FTetrisSimConfig& Config);
+}
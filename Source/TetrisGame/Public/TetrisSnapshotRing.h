@@ -0,0 +1,89 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TetrisBoardGrid.h"
+#include "TetrisPieceSpawner.h"
+
+// Board state just before a piece spawns; restoring it and spawning again replays that piece
+struct FTetrisBoardSnapshot
+{
+    // Shares row chunks with the live grid until either side writes to them
+    FTetrisBoardGrid Grid;
+    FTetrisSpawnerState SpawnerState;
+    int32 Score = 0;
+    // Number of the piece about to spawn, counting from 0 at the start of the game
+    int32 PieceNumber = 0;
+};
+
+/*
+ * Fixed-capacity undo history. Entries hold consecutive piece numbers; a cursor marks the
+ * current one, and pushing after an undo drops the redo entries. A full ring evicts the oldest.
+ *
+ * Most entries only store the rows that changed since the previous entry (a lock touches a few
+ * rows, a clear the rows above it). Every KeyframeInterval entries, and whenever the change
+ * spans more than a chunk, an entry keeps a whole grid instead, which shares unchanged chunks
+ * with its neighbours. Reading an entry rebuilds it from the keyframe at or before it, so a
+ * step or seek applies at most KeyframeInterval - 1 deltas.
+ */
+class TETRISGAME_API FTetrisSnapshotRing
+{
+public:
+    // Resizing drops the history
+    void SetCapacity(int32 InCapacity);
+    int32 GetCapacity() const { return Entries.Num(); }
+
+    void Reset();
+
+    void Push(FTetrisBoardSnapshot&& Snapshot);
+
+    // Move the cursor one entry back/forward, null if there is none
+    const FTetrisBoardSnapshot* StepBack();
+    const FTetrisBoardSnapshot* StepForward();
+
+    // Move the cursor to the entry for PieceNumber, null if it is not in the history
+    const FTetrisBoardSnapshot* SeekTo(int32 PieceNumber);
+
+    bool CanStepBack() const { return Cursor > 0; }
+    bool CanStepForward() const { return Cursor + 1 < Num; }
+    int32 GetNum() const { return Num; }
+
+    // Piece numbers covered by the history, INDEX_NONE when empty
+    int32 GetOldestPieceNumber() const { return Num > 0 ? Get(0).PieceNumber : INDEX_NONE; }
+    int32 GetNewestPieceNumber() const { return Num > 0 ? Get(Num - 1).PieceNumber : INDEX_NONE; }
+
+    // Memory held by the history, counting shared chunks once
+    SIZE_T GetAllocatedSize() const;
+
+    static constexpr int32 KeyframeInterval = 64;
+
+private:
+    struct FEntry
+    {
+        FTetrisSpawnerState SpawnerState;
+        int32 Score = 0;
+        int32 PieceNumber = 0;
+        // Whole grid, or null for a delta entry
+        TUniquePtr<FTetrisBoardGrid> Keyframe;
+        // Runs of replaced rows: a (StartRow << 32 | NumRows) word, then the rows' words
+        TArray<uint64> Delta;
+    };
+
+    const FEntry& Get(int32 Index) const { return Entries[(Head + Index) % Entries.Num()]; }
+    FEntry& Get(int32 Index) { return Entries[(Head + Index) % Entries.Num()]; }
+
+    // Release entries at and above Index
+    void Truncate(int32 Index);
+
+    // Rebuild entry Index into Current, moving the cursor there
+    const FTetrisBoardSnapshot* Materialize(int32 Index);
+
+    static void ApplyDelta(const TArray<uint64>& Delta, FTetrisBoardGrid& Grid);
+
+    TArray<FEntry> Entries;
+    // The entry at the cursor, rebuilt; its grid shares chunks with whatever it was restored to
+    FTetrisBoardSnapshot Current;
+    // Storage slot of the oldest entry
+    int32 Head = 0;
+    int32 Num = 0;
+    int32 Cursor = INDEX_NONE;
+};
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TetrisSolver.generated.h"
+
+// Standard pieces, in TetrisSimulation::GetStandardShapes order
+UENUM(BlueprintType)
+enum class ETetrisPieceShape : uint8
+{
+    I,
+    O,
+    T,
+    S,
+    Z,
+    J,
+    L,
+};
+
+UENUM(BlueprintType)
+enum class ETetrisSolverGoal : uint8
+{
+    // Leave the board empty
+    PerfectClear,
+    // Clear at least LinesToClear lines
+    ClearLines,
+};
+
+USTRUCT(BlueprintType)
+struct TETRISGAME_API FTetrisSolverStep
+{
+    GENERATED_BODY()
+
+    UPROPERTY(BlueprintReadOnly, Category = "Tetris Solver")
+    ETetrisPieceShape Shape = ETetrisPieceShape::I;
+
+    // Index into the shape's distinct rotations
+    UPROPERTY(BlueprintReadOnly, Category = "Tetris Solver")
+    int32 Rotation = 0;
+
+    // Cells the piece locks into, in board coordinates at the time it is placed (earlier clears applied)
+    UPROPERTY(BlueprintReadOnly, Category = "Tetris Solver")
+    TArray<FIntPoint> Cells;
+};
+
+USTRUCT(BlueprintType)
+struct TETRISGAME_API FTetrisSolution
+{
+    GENERATED_BODY()
+
+    UPROPERTY(BlueprintReadOnly, Category = "Tetris Solver")
+    TArray<FTetrisSolverStep> Steps;
+};
+
+struct FTetrisSolverRequest
+{
+    // Packed rows, one word per row (bit X = column X, row 0 at the bottom), Width <= 64
+    TArray<uint64> Rows;
+    int32 Width = 10;
+
+    // Pieces in the order they arrive; no hold
+    TArray<ETetrisPieceShape> Queue;
+
+    ETetrisSolverGoal Goal = ETetrisSolverGoal::PerfectClear;
+
+    // ClearLines: lines needed. PerfectClear: height of the clear, 0 picks the lowest one the queue can fill.
+    int32 LinesToClear = 0;
+
+    // Enumerate every solution instead of stopping at the first
+    bool bFindAll = false;
+    int32 MaxSolutions = 10000;
+
+    // Wall-clock limit, 0 for none
+    double TimeBudgetSeconds = 1.0;
+
+    // Split the top of the search tree across worker threads
+    bool bParallel = true;
+};
+
+struct FTetrisSolverResult
+{
+    TArray<FTetrisSolution> Solutions;
+    int64 NodesVisited = 0;
+    int64 MemoHits = 0;
+    int64 Pruned = 0;
+    bool bTimedOut = false;
+    // Find-all only: more than MaxSolutions exist, so Solutions is not the full list
+    bool bTruncated = false;
+    double Seconds = 0.0;
+
+    // True when the search space was exhausted, so an empty result means "unsolvable"
+    // and a find-all result is every solution
+    bool IsComplete() const { return !bTimedOut && !bTruncated; }
+};
+
+/*
+ * Depth-first search over placements on packed rows.
+ *
+ * Placements are those reachable by rotating at the spawn position, then moving left, right
+ * and down (so tucks and slides are found, but not kick-based spins, which the game's
+ * rotation does not have). Dead-end states are memoized by hash in a sharded set shared by all
+ * workers. Perfect-clear searches also prune on a ceiling and on column parity: vertical I, T
+ * and J/L shift the even/odd column balance of the empty cells by fixed amounts, and the
+ * remaining queue has to be able to make up the current imbalance. Enclosed empty regions are
+ * not pruned by size, since a line clear can merge a pocket with the space above it.
+ */
+namespace TetrisSolver
+{
+    TETRISGAME_API FTetrisSolverResult Solve(const FTetrisSolverRequest& Request);
+
+    // "IOTSZJL" letters to shapes, false on any other character
+    TETRISGAME_API bool ParseQueue(const FString& Text, TArray<ETetrisPieceShape>& OutQueue);
+}
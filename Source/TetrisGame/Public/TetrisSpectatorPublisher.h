@@ -0,0 +1,131 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "TetrisSpectatorStream.h"
+#include "TetrisSpectatorPublisher.generated.h"
+
+class ATetrisBoard;
+class ATetrisPiece;
+class FTetrisSpectatorServer;
+
+/*
+ * Publishes board deltas for spectators.
+ * Each board event is encoded once into a shared FTetrisSpectatorStream; every subscriber
+ * (in-process cursors or loopback TCP clients) copies the same bytes, so encoding cost
+ * does not grow with the number of observers.
+ */
+UCLASS(ClassGroup = (Tetris), meta = (BlueprintSpawnableComponent))
+class TETRISGAME_API UTetrisSpectatorPublisher : public UActorComponent
+{
+    GENERATED_BODY()
+
+public:
+    UTetrisSpectatorPublisher();
+    virtual ~UTetrisSpectatorPublisher();
+
+    // Attach to a board (defaults to the owning actor when it is a board)
+    UFUNCTION(BlueprintCallable, Category = "Tetris Spectator")
+    void SetBoard(ATetrisBoard* InBoard);
+
+    // Number of connected TCP subscribers
+    UFUNCTION(BlueprintPure, Category = "Tetris Spectator")
+    int32 GetSubscriberCount() const;
+
+    // Shared stream, for in-process subscribers (see FTetrisSpectatorCursor)
+    TSharedRef<FTetrisSpectatorStream, ESPMode::ThreadSafe> GetStream() const { return Stream; }
+
+protected:
+    virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+    // Size of the shared frame ring in bytes
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Tetris Spectator", meta = (ClampMin = "1024"))
+    int32 RingCapacityBytes = 256 * 1024;
+
+    // Refresh the late-joiner snapshot after this many frames so joiners replay a short tail
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Tetris Spectator", meta = (ClampMin = "1"))
+    int32 SnapshotInterval = 256;
+
+    // Serve the stream to loopback TCP clients
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Tetris Spectator")
+    bool bListenTcp = false;
+
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Tetris Spectator", meta = (EditCondition = "bListenTcp"))
+    int32 ListenPort = 7877;
+
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Tetris Spectator", meta = (EditCondition = "bListenTcp"))
+    int32 MaxSubscribers = 1024;
+
+private:
+    UFUNCTION()
+    void HandleBoardInitialized(int32 InWidth, int32 InHeight);
+
+    UFUNCTION()
+    void HandlePieceLocked(ATetrisPiece* LockedPiece, FVector PieceLocation, FRotator PieceRotation);
+
+    UFUNCTION()
+    void HandleLinesCleared(int32 LinesCleared, int32 NewScore);
+
+    UFUNCTION()
+    void HandleNewPieceSpawned(ATetrisPiece* NewPiece);
+
+    UFUNCTION()
+    void HandleGameOver();
+
+    void HandleBoardRevisionChanged(uint32 Revision);
+
+    void HandleRowsChanged(int32 MinRow, int32 MaxRow);
+
+    void BindBoard();
+    void UnbindBoard();
+
+    // Pull the dirty rows into the shadow copy and emit a RowsChanged frame for any that differ
+    void EmitRowDiff();
+
+    // Emit the active piece if it moved since the last frame
+    void EmitActivePiece();
+
+    void EmitPieceCells(ETetrisSpectatorFrame Type, ATetrisPiece* Piece);
+
+    // Cell list in the ActivePiece layout
+    void WriteCells(const TArray<FIntPoint>& Cells);
+
+    // Encode the shadow board and the active piece as the late-joiner snapshot
+    void RefreshSnapshot();
+
+    void Append(ETetrisSpectatorFrame Type);
+
+    template <typename T>
+    void Write(const T& Value)
+    {
+        const int32 At = Scratch.AddUninitialized(sizeof(T));
+        FMemory::Memcpy(Scratch.GetData() + At, &Value, sizeof(T));
+    }
+
+    UPROPERTY()
+    TObjectPtr<ATetrisBoard> Board;
+
+    TSharedRef<FTetrisSpectatorStream, ESPMode::ThreadSafe> Stream;
+    TUniquePtr<FTetrisSpectatorServer> Server;
+    FDelegateHandle RevisionHandle;
+    FDelegateHandle RowsChangedHandle;
+
+    // Last published board rows, packed TetrisSpectator::BytesPerRow(Width) bytes each
+    TArray<uint8> ShadowRows;
+    int32 ShadowWidth = 0;
+    int32 ShadowHeight = 0;
+
+    // Rows the board reported as changed since the last diff; empty when DirtyMaxRow < DirtyMinRow.
+    // Piece moves bump the revision without touching the grid, so they diff nothing.
+    int32 DirtyMinRow = 0;
+    int32 DirtyMaxRow = -1;
+
+    TArray<FIntPoint> LastActiveCells;
+    TArray<FIntPoint> ScratchCells;
+
+    // Reused encode buffer, so steady-state publishing does not allocate
+    TArray<uint8> Scratch;
+
+    uint32 FramesSinceSnapshot = 0;
+};
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FTetrisBoardGrid;
+
+/*
+ * Wire format shared by every spectator transport. Each frame is:
+ *   uint32 Size (header + payload), uint32 Sequence, uint8 Type, payload
+ * Frames are encoded once by the publisher and copied verbatim to every subscriber.
+ */
+enum class ETetrisSpectatorFrame : uint8
+{
+    // Full board: uint16 Width, uint16 Height, int32 Score, Height packed rows,
+    // then the active piece in the ActivePiece layout (Count 0 when there is none)
+    Snapshot,
+    // uint16 Count, then Count x (uint16 Row, packed row)
+    RowsChanged,
+    // uint8 Count, then Count x (int16 X, int16 Y)
+    ActivePiece,
+    // Same layout as ActivePiece, cells of the piece that was locked
+    PieceLocked,
+    // Same layout as ActivePiece, cells of the piece that was spawned
+    PieceSpawned,
+    // uint8 LinesCleared, int32 NewScore
+    LinesCleared,
+    // No payload
+    GameOver,
+};
+
+namespace TetrisSpectator
+{
+    constexpr int32 FrameHeaderSize = sizeof(uint32) + sizeof(uint32) + sizeof(uint8);
+
+    // Bytes needed for one packed row of the given width
+    inline int32 BytesPerRow(int32 Width) { return (Width + 7) / 8; }
+
+    // Append a RowsChanged payload to Out for the rows in [MinRow, MaxRow] that differ from
+    // ShadowRows (BytesPerRow(Width) bytes per row), and bring ShadowRows up to date.
+    // Returns the number of rows encoded; nothing is appended when none changed.
+    TETRISGAME_API int32 EncodeRowDiff(const FTetrisBoardGrid& Grid, int32 MinRow, int32 MaxRow, TArray<uint8>& ShadowRows, TArray<uint8>& Out);
+}
+
+/*
+ * Fixed-size ring of encoded frames shared by all subscribers.
+ * One writer (the game thread) appends; any number of readers copy frames out by sequence number.
+ * Late joiners start from the cached snapshot and read the tail that follows it.
+ */
+class TETRISGAME_API FTetrisSpectatorStream
+{
+public:
+    explicit FTetrisSpectatorStream(int32 InCapacityBytes = 256 * 1024, int32 InMaxFrames = 4096);
+
+    // Drop every frame and the snapshot, keeping sequence numbers monotonic. Existing readers
+    // fall behind the tail, so their next read fails and they resync from the next snapshot.
+    void Reset();
+
+    // Encode the header in place and append. Returns the frame's sequence number.
+    uint32 Append(ETetrisSpectatorFrame Type, const uint8* Payload, int32 PayloadSize);
+
+    // Store a snapshot that reflects every frame before the current head
+    void SetSnapshot(const uint8* Payload, int32 PayloadSize);
+
+    // Copy the snapshot frame; OutNextSequence is the first frame to read after it
+    bool GetSnapshot(TArray<uint8>& OutBytes, uint32& OutNextSequence) const;
+
+    // Append frames [FromSequence, head) to OutBytes, up to MaxBytes.
+    // Returns false if FromSequence has already been evicted and the reader must resync from a snapshot.
+    bool ReadFrom(uint32 FromSequence, TArray<uint8>& OutBytes, uint32& OutNextSequence, int32 MaxBytes = MAX_int32) const;
+
+    uint32 GetHeadSequence() const;
+    uint32 GetTailSequence() const;
+    uint32 GetSnapshotSequence() const;
+
+private:
+    struct FFrameRef
+    {
+        uint64 Offset;
+        uint32 Size;
+    };
+
+    void EvictFor(uint32 FrameSize);
+    void CopyOut(uint64 Offset, uint32 Size, uint8* Dest) const;
+
+    mutable FRWLock Lock;
+
+    TArray<uint8> Buffer;
+    TArray<FFrameRef> Frames;
+
+    // Monotonic byte position of the next write; Buffer index is WriteOffset % capacity
+    uint64 WriteOffset = 0;
+    uint32 HeadSequence = 0;
+    uint32 TailSequence = 0;
+
+    TArray<uint8> SnapshotBytes;
+    uint32 SnapshotSequence = 0;
+};
+
+/*
+ * In-process subscriber. Holds only a sequence number, so any number of cursors can share one stream.
+ */
+struct TETRISGAME_API FTetrisSpectatorCursor
+{
+    // Next sequence to read, or INDEX_NONE before the first poll
+    int64 NextSequence = INDEX_NONE;
+
+    // Append newly available bytes to OutBytes (starting with a snapshot when joining or after falling behind)
+    void Poll(const FTetrisSpectatorStream& Stream, TArray<uint8>& OutBytes, int32 MaxBytes = MAX_int32);
+};
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "TetrisHistogram.h"
+#include "TetrisTelemetryComponent.generated.h"
+
+class ATetrisBoard;
+class ATetrisPiece;
+
+UENUM(BlueprintType)
+enum class ETetrisInputAction : uint8
+{
+    MoveLeft,
+    MoveRight,
+    SoftDrop,
+    Rotate,
+    HardDrop,
+};
+
+UENUM(BlueprintType)
+enum class ETetrisTelemetrySink : uint8
+{
+    // Append one row per flush to Saved/Telemetry/<GameId>.csv (GameId names the board, start time and a unique suffix)
+    Csv,
+    // Append one JSON object per flush to Saved/Telemetry/<GameId>.jsonl
+    Json,
+    // Publish as custom stats to the CSV profiler (csvprofile start/stop)
+    CsvProfiler,
+};
+
+/*
+ * Per-game gameplay telemetry: pieces per second, actions per minute, finesse faults,
+ * lines and attack, plus placement and input-to-lock timing histograms.
+ * Recording only touches atomics and fixed arrays; formatting and file IO happen at flush.
+ *
+ * A game's clock starts at its first spawn. Game over (or the board initializing again)
+ * flushes a final row and starts the next game with fresh totals under a new GameId and file.
+ */
+UCLASS(ClassGroup = (Tetris), meta = (BlueprintSpawnableComponent))
+class TETRISGAME_API UTetrisTelemetryComponent : public UActorComponent
+{
+    GENERATED_BODY()
+
+public:
+    UTetrisTelemetryComponent();
+
+    // Record a player input against the current piece
+    UFUNCTION(BlueprintCallable, Category = "Tetris Telemetry")
+    void RecordAction(ETetrisInputAction Action);
+
+    // Write the current game's totals to the configured sink; nothing before its first spawn
+    UFUNCTION(BlueprintCallable, Category = "Tetris Telemetry")
+    void Flush();
+
+    UFUNCTION(BlueprintPure, Category = "Tetris Telemetry")
+    float GetPiecesPerSecond() const;
+
+    UFUNCTION(BlueprintPure, Category = "Tetris Telemetry")
+    float GetActionsPerMinute() const;
+
+    UFUNCTION(BlueprintPure, Category = "Tetris Telemetry")
+    int32 GetFinesseFaults() const { return static_cast<int32>(FinesseFaults.load(std::memory_order_relaxed)); }
+
+    const FTetrisHistogram& GetPlacementTimeHistogram() const { return PlacementTimeUs; }
+    const FTetrisHistogram& GetInputToLockHistogram() const { return InputToLockUs; }
+
+protected:
+    virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Tetris Telemetry")
+    ETetrisTelemetrySink Sink = ETetrisTelemetrySink::Csv;
+
+    // Seconds between flushes, 0 flushes only at end of play
+    UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Tetris Telemetry", meta = (ClampMin = "0"))
+    float FlushInterval = 10.f;
+
+private:
+    UFUNCTION()
+    void HandleBoardInitialized(int32 Width, int32 Height);
+
+    UFUNCTION()
+    void HandleGameOver();
+
+    UFUNCTION()
+    void HandleNewPieceSpawned(ATetrisPiece* NewPiece);
+
+    UFUNCTION()
+    void HandlePieceLocked(ATetrisPiece* LockedPiece, FVector PieceLocation, FRotator PieceRotation);
+
+    // Bound to the board's native row-clear hook, which fires for clears on lock too
+    void HandleRowsCleared(int32 LinesCleared);
+
+    double SecondsSinceStart() const;
+
+    // Flush the game in progress, if it got as far as a spawn, and reset for the next one
+    void StartGame();
+
+    UPROPERTY()
+    TObjectPtr<ATetrisBoard> Board;
+
+    FTimerHandle FlushTimerHandle;
+    FString GameId;
+    FString OutputPath;
+    bool bWroteCsvHeader = false;
+
+    // First spawn of the current game, 0 until then
+    uint64 StartCycles = 0;
+
+    std::atomic<uint64> Pieces { 0 };
+    std::atomic<uint64> Actions { 0 };
+    std::atomic<uint64> FinesseFaults { 0 };
+    std::atomic<uint64> Lines { 0 };
+    std::atomic<uint64> Attack { 0 };
+
+    // Spawn (or first input) to lock
+    FTetrisHistogram PlacementTimeUs;
+    // Last input to lock
+    FTetrisHistogram InputToLockUs;
+
+    // Inputs against the current piece, used for the finesse check
+    uint64 PieceStartCycles = 0;
+    uint64 LastInputCycles = 0;
+    int32 PieceShift = 0;
+    int32 PieceRotations = 0;
+    int32 PieceMoveInputs = 0;
+};
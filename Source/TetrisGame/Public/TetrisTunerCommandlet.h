@@ -0,0 +1,27 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "TetrisTunerCommandlet.generated.h"
+
+/*
+ * Offline bot weight tuning, meant for unattended build machines:
+ *
+ *   UnrealEditor-Cmd <Project>.uproject -run=TetrisTuner -unattended -nullrhi
+ *       [-Generations=50] [-Population=64] [-Games=8] [-Pieces=500] [-Seed=1]
+ *       [-Checkpoint=<file>] [-Output=/Game/AI/DA_TetrisBotWeights] [-Fresh]
+ *
+ * A checkpoint is written after every generation and picked up on the next run (unless -Fresh),
+ * so an interrupted job continues where it stopped. -Generations is the total, not the number
+ * to add. The best weights are saved to the -Output data asset at the end.
+ */
+UCLASS()
+class TETRISGAME_API UTetrisTunerCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+public:
+    UTetrisTunerCommandlet();
+
+    virtual int32 Main(const FString& Params) override;
+};
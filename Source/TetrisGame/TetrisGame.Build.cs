@@ -38,12 +38,13 @@ public class TetrisGame : ModuleRules
 			new string[]
 			{
 				"Core",	// Core UE4 functionality
+				"SlateCore",	// Board widget derives from SLeafWidget
+				"UMG",			// Board widget UMG wrapper
 				
 				// Common public dependencies:
 				// "CoreUObject",	// Core UE4 object functionality
 				// "Engine",		// Core engine functionality
 				// "Networking",	// For network functionality
-				// "UMG",			// For UI functionality
 			}
 		);
 			
@@ -55,8 +56,10 @@ public class TetrisGame : ModuleRules
 				"CoreUObject",	// Core UE4 object functionality
 				"Engine",		// Core engine functionality
 				"Slate",		// UI framework
-				"SlateCore",	// Core UI functionality
 				"EnhancedInput",// Enhanced input system
+				"Sockets",		// Spectator loopback server
+				"Networking",	// TcpSocketBuilder
+				"Projects",		// Plugin directory for the puzzle commandlet
 				
 				// Common private dependencies:
 				// "RenderCore",	// Rendering core functionality